@@ -0,0 +1,26 @@
+#include "ColorAccumulator.h"
+
+// per channel, rounded: (base * (256 - weight) + previous * weight) / 256
+static inline uint16_t blendChannel(uint16_t base, uint16_t previous, uint16_t baseWeight, uint16_t weight)
+{
+    return (uint16_t)(((uint32_t)base * baseWeight + (uint32_t)previous * weight + 128) >> 8);
+}
+
+bool ColorAccumulator::blendSpan(int xStart, int y, const Cell *baseCells, int count, uint16_t weight, uint16_t *dest)
+{
+    bool unchanged = true;
+    uint16_t baseWeight = 256 - weight;
+    Cell *span = &cells[y][xStart];
+    for (int i = 0; i < count; i++)
+    {
+        Cell previous = span[i];
+        Cell blended;
+        blended.r = blendChannel(baseCells[i].r, previous.r, baseWeight, weight);
+        blended.g = blendChannel(baseCells[i].g, previous.g, baseWeight, weight);
+        blended.b = blendChannel(baseCells[i].b, previous.b, baseWeight, weight);
+        unchanged &= (blended.r == previous.r) && (blended.g == previous.g) && (blended.b == previous.b);
+        span[i] = blended;
+        dest[i] = to565(blended);
+    }
+    return unchanged;
+}
@@ -0,0 +1,62 @@
+#ifndef COLORACCUMULATOR_H
+#define COLORACCUMULATOR_H
+
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include "FrameBuffer.h"
+
+// High-precision colour buffer for trail effects.
+// Every cell keeps its r, g, b channels as 8.8 fixed point, so repeated blends with the
+// previous colour aren't re-quantised to the 565 grid every frame. The 565 colour for the
+// panel is produced from the accumulated colour once, as each cell is blended.
+// Costs 6 bytes per cell (12KB for 64x32), see getMemoryBytes(). Stored row-major like FrameBuffer.
+// Usage:
+//     ColorAccumulator *accumulator = new ColorAccumulator();
+//     accumulator->setCell(x, y, ColorAccumulator::fromRGB(r, g, b));
+//     accumulator->blendSpan(xStart, y, baseCells, count, prevInfluence, frame.span(xStart, y));
+class ColorAccumulator
+{
+public:
+    static const int WIDTH = FrameBuffer::WIDTH;
+    static const int HEIGHT = FrameBuffer::HEIGHT;
+
+    // one colour, each channel 8.8 fixed point (integer part = 8-bit channel value)
+    struct Cell
+    {
+        uint16_t r;
+        uint16_t g;
+        uint16_t b;
+    };
+
+    static Cell fromRGB(uint8_t r, uint8_t g, uint8_t b)
+    {
+        Cell cell = {(uint16_t)(r << 8), (uint16_t)(g << 8), (uint16_t)(b << 8)};
+        return cell;
+    }
+    // 565 colour from the integer part of each channel, the same as Matrix::rgbTo565()
+    static uint16_t to565(const Cell &cell)
+    {
+        return (cell.r & 0xF800) | ((cell.g & 0xFC00) >> 5) | (cell.b >> 11);
+    }
+
+    ColorAccumulator() { clear(); }
+
+    void clear() { memset(cells.data(), 0, sizeof(cells)); }
+    void setCell(int x, int y, const Cell &cell) { cells[y][x] = cell; }
+    const Cell &getCell(int x, int y) const { return cells[y][x]; }
+
+    // bytes used by the accumulated colours
+    size_t getMemoryBytes() const { return sizeof(cells); }
+
+    // blend 'count' base colours into the cells of row y from xStart, with the previous
+    // colours having 'weight' influence (0-256, 256 = keep previous), and write the 565 results
+    // to dest. returns true if no accumulated colour changed
+    bool blendSpan(int xStart, int y, const Cell *baseCells, int count, uint16_t weight, uint16_t *dest);
+
+private:
+    std::array<std::array<Cell, WIDTH>, HEIGHT> cells;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "ColorMath.h"
+
+// 32-bit view of 16-bit pixel rows, allowed to alias the uint16_t buffers
+typedef uint32_t __attribute__((may_alias)) PixelPair;
+
+namespace ColorMath
+{
+    void blendRow565(uint16_t *dest, const uint16_t *base, const uint16_t *other, int count, uint16_t weight)
+    {
+        PixelPair *destPairs = reinterpret_cast<PixelPair *>(dest);
+        const PixelPair *basePairs = reinterpret_cast<const PixelPair *>(base);
+        const PixelPair *otherPairs = reinterpret_cast<const PixelPair *>(other);
+        int pairs = count / 2;
+        for (int i = 0; i < pairs; i++)
+        {
+            destPairs[i] = blend565x2(basePairs[i], otherPairs[i], weight);
+        }
+        if (count & 1)
+        {
+            dest[count - 1] = low(blend565x2(base[count - 1], other[count - 1], weight));
+        }
+    }
+
+    void addSaturateRow565(uint16_t *dest, const uint16_t *a, const uint16_t *b, int count)
+    {
+        PixelPair *destPairs = reinterpret_cast<PixelPair *>(dest);
+        const PixelPair *aPairs = reinterpret_cast<const PixelPair *>(a);
+        const PixelPair *bPairs = reinterpret_cast<const PixelPair *>(b);
+        int pairs = count / 2;
+        for (int i = 0; i < pairs; i++)
+        {
+            destPairs[i] = addSaturate565x2(aPairs[i], bPairs[i]);
+        }
+        if (count & 1)
+        {
+            dest[count - 1] = low(addSaturate565x2(a[count - 1], b[count - 1]));
+        }
+    }
+
+    void maxRow565(uint16_t *dest, const uint16_t *a, const uint16_t *b, int count)
+    {
+        PixelPair *destPairs = reinterpret_cast<PixelPair *>(dest);
+        const PixelPair *aPairs = reinterpret_cast<const PixelPair *>(a);
+        const PixelPair *bPairs = reinterpret_cast<const PixelPair *>(b);
+        int pairs = count / 2;
+        for (int i = 0; i < pairs; i++)
+        {
+            destPairs[i] = max565x2(aPairs[i], bPairs[i]);
+        }
+        if (count & 1)
+        {
+            dest[count - 1] = low(max565x2(a[count - 1], b[count - 1]));
+        }
+    }
+}
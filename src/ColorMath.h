@@ -0,0 +1,75 @@
+#ifndef COLORMATH_H
+#define COLORMATH_H
+
+#pragma once
+
+#include <Arduino.h>
+
+// SWAR (SIMD within a register) RGB565 colour maths.
+// Two 565 pixels are packed into one 32-bit word (first pixel in the low half) and each
+// channel is worked on in its own 16-bit lane, so every multiply handles two pixels at once.
+// Blends work directly on the 5/6-bit channels, with no unpacking to 8-bit RGB.
+// Usage:
+//     uint32_t two = ColorMath::pack2(pixel0, pixel1);
+//     two = ColorMath::blend565x2(two, ColorMath::pack2(other0, other1), 200);
+//     ColorMath::blendRow565(dest, base, other, count, 200); // whole rows, see below
+namespace ColorMath
+{
+    // lane masks for the channels of two pixels, and the channels shifted down to bit 0 of each lane
+    const uint32_t RED_MASK_X2 = 0xF800F800;
+    const uint32_t GREEN_MASK_X2 = 0x07E007E0;
+    const uint32_t BLUE_MASK_X2 = 0x001F001F;
+    const uint32_t LANE_5BIT_X2 = 0x001F001F;
+    const uint32_t LANE_6BIT_X2 = 0x003F003F;
+
+    inline uint32_t pack2(uint16_t pixel0, uint16_t pixel1) { return (uint32_t)pixel0 | ((uint32_t)pixel1 << 16); }
+    inline uint16_t low(uint32_t pixels) { return (uint16_t)pixels; }
+    inline uint16_t high(uint32_t pixels) { return (uint16_t)(pixels >> 16); }
+
+    // per channel: (base * (256 - weight) + other * weight) >> 8, weight 0-256 (256 = all other)
+    inline uint32_t blend565x2(uint32_t base, uint32_t other, uint16_t weight)
+    {
+        uint16_t baseWeight = 256 - weight;
+        uint32_t r = ((((base >> 11) & LANE_5BIT_X2) * baseWeight + ((other >> 11) & LANE_5BIT_X2) * weight) >> 8) & LANE_5BIT_X2;
+        uint32_t g = ((((base >> 5) & LANE_6BIT_X2) * baseWeight + ((other >> 5) & LANE_6BIT_X2) * weight) >> 8) & LANE_6BIT_X2;
+        uint32_t b = (((base & LANE_5BIT_X2) * baseWeight + (other & LANE_5BIT_X2) * weight) >> 8) & LANE_5BIT_X2;
+        return (r << 11) | (g << 5) | b;
+    }
+
+    // per channel: min(a + b, channel max)
+    inline uint32_t addSaturate565x2(uint32_t a, uint32_t b)
+    {
+        // add each channel in its own lane, then turn carries out of the channel into all-ones
+        uint32_t r = ((a >> 11) & LANE_5BIT_X2) + ((b >> 11) & LANE_5BIT_X2);
+        uint32_t g = ((a >> 5) & LANE_6BIT_X2) + ((b >> 5) & LANE_6BIT_X2);
+        uint32_t bl = (a & LANE_5BIT_X2) + (b & LANE_5BIT_X2);
+        r = (r | (((r >> 5) & 0x00010001) * 0x1F)) & LANE_5BIT_X2;
+        g = (g | (((g >> 6) & 0x00010001) * 0x3F)) & LANE_6BIT_X2;
+        bl = (bl | (((bl >> 5) & 0x00010001) * 0x1F)) & LANE_5BIT_X2;
+        return (r << 11) | (g << 5) | bl;
+    }
+
+    // per channel: max(a, b)
+    inline uint32_t max565x2(uint32_t a, uint32_t b)
+    {
+        // a guard bit above each channel survives the subtraction only where a >= b
+        uint32_t ra = (a >> 11) & LANE_5BIT_X2, rb = (b >> 11) & LANE_5BIT_X2;
+        uint32_t ga = (a >> 5) & LANE_6BIT_X2, gb = (b >> 5) & LANE_6BIT_X2;
+        uint32_t ba = a & LANE_5BIT_X2, bb = b & LANE_5BIT_X2;
+        uint32_t rKeepA = ((((ra | 0x00200020) - rb) >> 5) & 0x00010001) * 0x1F;
+        uint32_t gKeepA = ((((ga | 0x00400040) - gb) >> 6) & 0x00010001) * 0x3F;
+        uint32_t bKeepA = ((((ba | 0x00200020) - bb) >> 5) & 0x00010001) * 0x1F;
+        uint32_t r = (ra & rKeepA) | (rb & ~rKeepA & LANE_5BIT_X2);
+        uint32_t g = (ga & gKeepA) | (gb & ~gKeepA & LANE_6BIT_X2);
+        uint32_t bl = (ba & bKeepA) | (bb & ~bKeepA & LANE_5BIT_X2);
+        return (r << 11) | (g << 5) | bl;
+    }
+
+    // whole-row versions, two pixels per word. dest may be the same as base or other.
+    // rows must be 4-byte aligned; an odd last pixel is handled on its own.
+    void blendRow565(uint16_t *dest, const uint16_t *base, const uint16_t *other, int count, uint16_t weight);
+    void addSaturateRow565(uint16_t *dest, const uint16_t *a, const uint16_t *b, int count);
+    void maxRow565(uint16_t *dest, const uint16_t *a, const uint16_t *b, int count);
+}
+
+#endif
@@ -0,0 +1,165 @@
+#include "Compositor.h"
+
+const uint32_t Layer::ALL_ROWS;
+
+void Layer::blendRow(uint16_t *dest, const uint16_t *pixels, int count) const
+{
+    switch (mode)
+    {
+    case BLEND_REPLACE:
+        memcpy(dest, pixels, count * sizeof(uint16_t));
+        break;
+    case BLEND_ALPHA:
+        ColorMath::blendRow565(dest, dest, pixels, count, alpha);
+        break;
+    case BLEND_ADD:
+        ColorMath::addSaturateRow565(dest, dest, pixels, count);
+        break;
+    case BLEND_MAX:
+        ColorMath::maxRow565(dest, dest, pixels, count);
+        break;
+    }
+}
+
+void Layer::blendPixel(uint16_t &dest, uint16_t color) const
+{
+    switch (mode)
+    {
+    case BLEND_REPLACE:
+        dest = color;
+        break;
+    case BLEND_ALPHA:
+        dest = ColorMath::low(ColorMath::blend565x2(dest, color, alpha));
+        break;
+    case BLEND_ADD:
+        dest = ColorMath::low(ColorMath::addSaturate565x2(dest, color));
+        break;
+    case BLEND_MAX:
+        dest = ColorMath::low(ColorMath::max565x2(dest, color));
+        break;
+    }
+}
+
+// whole rows at a time
+void FrameLayer::compose(FrameBuffer &target, uint32_t rows)
+{
+    alignas(4) uint16_t colors[FrameBuffer::WIDTH];
+    for (int y = 0; y < FrameBuffer::HEIGHT; y++)
+    {
+        if (!(rows & ((uint32_t)1 << y)))
+            continue;
+        if (frame.format == FRAME_FORMAT_RGB565)
+        {
+            blendRow(target.row(y), frame.colors->row(y), FrameBuffer::WIDTH);
+        }
+        else if (mode == BLEND_REPLACE)
+        {
+            // looked up straight into the frame
+            frame.readRow(y, target.row(y));
+        }
+        else
+        {
+            frame.readRow(y, colors);
+            blendRow(target.row(y), colors, FrameBuffer::WIDTH);
+        }
+    }
+}
+
+void MaskLayer::setMask(const TextMask &mask, uint16_t color)
+{
+    for (int y = 0; y < FrameBuffer::HEIGHT; y++)
+    {
+        if (mask.getRow(y) != this->mask.getRow(y))
+            damage |= (uint32_t)1 << y;
+    }
+    this->mask = mask;
+    if (color != this->color)
+    {
+        // every row of the mask is drawn in the new colour
+        damage |= getCoveredRows();
+        this->color = color;
+    }
+}
+
+uint32_t MaskLayer::getCoveredRows() const
+{
+    uint32_t rows = 0;
+    for (int y = mask.getTop(); y <= mask.getBottom(); y++)
+    {
+        if (mask.getRow(y) != 0)
+            rows |= (uint32_t)1 << y;
+    }
+    return rows;
+}
+
+// only the set bits of the rows in the mask's bounding box
+void MaskLayer::compose(FrameBuffer &target, uint32_t rows)
+{
+    for (int y = mask.getTop(); y <= mask.getBottom(); y++)
+    {
+        if (!(rows & ((uint32_t)1 << y)))
+            continue;
+        uint16_t *row = target.row(y);
+        uint64_t bits = mask.getRow(y);
+        while (bits != 0)
+        {
+            blendPixel(row[__builtin_ctzll(bits)], color);
+            bits &= bits - 1; // clear the lowest set bit
+        }
+    }
+}
+
+bool Compositor::addLayer(Layer *layer)
+{
+    if (layerCount >= COMPOSITOR_MAX_LAYERS)
+    {
+        Logger::printf("Compositor: no room for layer %s\n", layer->getName());
+        return false;
+    }
+    layers[layerCount++] = layer;
+    return true;
+}
+
+uint32_t Compositor::compose(FrameBuffer &frame)
+{
+    TRACE_ZONE("Compose");
+    // rows any layer changed in must be composed again from the bottom up
+    uint32_t rows = damage;
+    damage = 0;
+    for (int i = 0; i < layerCount; i++)
+    {
+        rows |= layers[i]->damage;
+        layers[i]->damage = 0;
+    }
+
+    // everything under the topmost opaque layer is covered, so start from there
+    int first = layerCount - 1;
+    while (first >= 0 && !layers[first]->isOpaque())
+    {
+        first--;
+    }
+    if (first < 0)
+    {
+        // nothing covers the frame, start from black
+        for (int y = 0; y < FrameBuffer::HEIGHT; y++)
+        {
+            if (rows & ((uint32_t)1 << y))
+                memset(frame.row(y), 0, FrameBuffer::WIDTH * sizeof(uint16_t));
+        }
+        first = 0;
+    }
+
+    for (int i = 0; i < layerCount; i++)
+    {
+        Layer *layer = layers[i];
+        if (rows == 0 || i < first || !layer->isVisible())
+        {
+            layer->cost = 0;
+            continue;
+        }
+        unsigned long tStart = micros();
+        layer->compose(frame, rows);
+        layer->cost = micros() - tStart;
+    }
+    return rows;
+}
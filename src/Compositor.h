@@ -0,0 +1,171 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#pragma once
+
+#include <Arduino.h>
+#include "FrameBuffer.h"
+#include "TextMask.h"
+#include "ColorMath.h"
+#include "Logger.h"
+#include "Trace.h"
+
+#define COMPOSITOR_MAX_LAYERS 8
+
+// how a layer's pixels combine with what's below them
+enum BlendMode
+{
+    BLEND_REPLACE, // layer pixel
+    BLEND_ALPHA,   // below blended toward the layer pixel by the layer's alpha
+    BLEND_ADD,     // per channel sum, saturating
+    BLEND_MAX      // per channel maximum
+};
+
+// A layer of the composed frame. Subclasses draw their pixels onto the frame with
+// blendRow()/blendPixel() in the layer's blend mode. Layers are set up once and drawn every frame.
+// Damage is kept as a row bitmap, bit y set if row y changed since the layer was last composed.
+// Subclasses add the rows their changes touch, so only those rows are composed again.
+class Layer
+{
+public:
+    static_assert(FrameBuffer::HEIGHT <= 32, "damage is one bit per row in a 32-bit word");
+    static const uint32_t ALL_ROWS = (uint32_t)(((uint64_t)1 << FrameBuffer::HEIGHT) - 1);
+
+    Layer(const char *name, BlendMode mode = BLEND_REPLACE) : name(name), mode(mode) {}
+    virtual ~Layer() {}
+
+    // draw the layer's pixels in the rows set in 'rows' onto frame
+    virtual void compose(FrameBuffer &frame, uint32_t rows) = 0;
+    // whether there's anything to draw
+    virtual bool isVisible() const { return enabled; }
+    // whether compose() sets every pixel regardless of those below, so the layers
+    // below it needn't be drawn and the frame needn't be cleared
+    virtual bool isOpaque() const { return false; }
+    // rows the layer draws on, as a row bitmap
+    virtual uint32_t getCoveredRows() const = 0;
+
+    // changing how the layer is drawn damages every row it covers
+    void setEnabled(bool enabled)
+    {
+        if (enabled != this->enabled)
+            damage |= getCoveredRows();
+        this->enabled = enabled;
+    }
+    void setBlendMode(BlendMode mode)
+    {
+        if (mode != this->mode)
+            damage |= getCoveredRows();
+        this->mode = mode;
+    }
+    // 0-256, how far BLEND_ALPHA moves toward the layer (256 = all layer)
+    void setAlpha(uint16_t alpha)
+    {
+        if (alpha != this->alpha)
+            damage |= getCoveredRows();
+        this->alpha = alpha;
+    }
+
+    const char *getName() const { return name; }
+    // µs the last compose() took, 0 if the layer wasn't drawn
+    unsigned long getCost() const { return cost; }
+
+protected:
+    const char *name;
+    BlendMode mode;
+    uint16_t alpha = 256;
+    bool enabled = true;
+    uint32_t damage = 0; // rows changed since last composed
+
+    // combine count layer pixels into dest in the blend mode
+    void blendRow(uint16_t *dest, const uint16_t *pixels, int count) const;
+    // combine a single colour into one pixel in the blend mode
+    void blendPixel(uint16_t &dest, uint16_t color) const;
+
+private:
+    unsigned long cost = 0;
+    friend class Compositor;
+};
+
+// a whole frame e.g. a matrix frame from the frame queue, in either frame format.
+// indexed frames are looked up in their palette as they're composed. not drawn if no frame is set
+class FrameLayer : public Layer
+{
+public:
+    FrameLayer(const char *name, BlendMode mode = BLEND_REPLACE) : Layer(name, mode) {}
+
+    // the frame to draw, an empty view for none. it must stay valid until the next compose.
+    // changed is false if it's the frame set before, unchanged. anything else, including
+    // the same indices under another palette, damages every row
+    void setFrame(const FrameView &frame, bool changed = true)
+    {
+        if (changed || frame != this->frame)
+            damage |= ALL_ROWS;
+        this->frame = frame;
+    }
+
+    void compose(FrameBuffer &frame, uint32_t rows) override;
+    bool isVisible() const override { return enabled && !frame.isEmpty(); }
+    bool isOpaque() const override { return isVisible() && mode == BLEND_REPLACE; }
+    uint32_t getCoveredRows() const override { return frame.isEmpty() ? 0 : ALL_ROWS; }
+
+private:
+    FrameView frame;
+};
+
+// the set pixels of a TextMask in one colour e.g. a sensor text. holds its own copy
+// of the mask, so the text can be rasterised again while the frame is composed
+class MaskLayer : public Layer
+{
+public:
+    MaskLayer(const char *name, BlendMode mode = BLEND_REPLACE) : Layer(name, mode) {}
+
+    // damages the rows where the mask differs, or all its rows if the colour changed
+    void setMask(const TextMask &mask, uint16_t color);
+
+    void compose(FrameBuffer &frame, uint32_t rows) override;
+    bool isVisible() const override { return enabled && !mask.isEmpty(); }
+    uint32_t getCoveredRows() const override;
+
+private:
+    TextMask mask;
+    uint16_t color = 0xFFFF;
+};
+
+// Composes ordered layers, bottom first, into one frame on the CPU, so the panel is
+// written once per frame instead of cleared and then drawn over layer by layer.
+// Only the layers from the topmost opaque one up are drawn; if none is opaque the
+// frame starts black. The time each layer takes is kept for logging.
+// The frame is kept between calls, and only the rows damaged by some layer since the
+// last compose are composed again. compose() returns them, so only they need writing out.
+// Usage:
+//     FrameLayer background("Background");
+//     MaskLayer text("Text", BLEND_MAX);
+//     compositor.addLayer(&background);
+//     compositor.addLayer(&text);
+//     // each frame
+//     background.setFrame(matrixFrame);
+//     text.setMask(mask, color);
+//     uint32_t rows = compositor.compose(frame);
+//     panel->writeRows(frame, rows);
+class Compositor
+{
+public:
+    // add a layer above those already added. false if there's no room
+    bool addLayer(Layer *layer);
+
+    // compose the damaged rows of the visible layers into frame. returns those rows
+    uint32_t compose(FrameBuffer &frame);
+
+    // compose every row next time e.g. when what the frame was written to was cleared
+    void invalidate() { damage = Layer::ALL_ROWS; }
+
+    int getLayerCount() const { return layerCount; }
+    const Layer *getLayer(int index) const { return layers[index]; }
+
+private:
+    Layer *layers[COMPOSITOR_MAX_LAYERS];
+    int layerCount = 0;
+    uint32_t damage = Layer::ALL_ROWS; // the frame starts out unknown
+};
+
+#endif
@@ -0,0 +1,356 @@
+#include "CpuMonitor.h"
+
+#ifndef ARDUINO
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <chrono>
+#endif
+
+CpuMonitor::CpuMonitor(int sampleMS)
+{
+    this->sampleMS = sampleMS;
+    this->enabled.store(false);
+
+    // Create mutex for the samples
+    samplesMutex = xSemaphoreCreateMutex();
+    if (samplesMutex == NULL)
+    {
+        Logger::println("ERROR: Failed to create CpuMonitor samplesMutex");
+    }
+
+    // create a low priority task to sample in the background
+    xTaskCreatePinnedToCore(
+        CpuMonitor::monitorTaskWrapper, // Function that should be called
+        "CpuMonitor Task",              // Name of the task (for debugging)
+        4096,                           // Stack size (bytes)
+        this,                           // Parameter to pass
+        1,                              // Task priority // lowest
+        &monitorTaskHandle,             // Task handle
+        CPU_MONITOR_CORE                // Core to run the task on (0 or 1)
+    );
+
+    if (monitorTaskHandle == NULL)
+    {
+        Logger::println("Failed to create CpuMonitor monitorTask");
+    }
+}
+
+CpuMonitor::~CpuMonitor()
+{
+    if (monitorTaskHandle != NULL)
+    {
+        vTaskDelete(monitorTaskHandle);
+    }
+    if (samplesMutex != NULL)
+    {
+        vSemaphoreDelete(samplesMutex);
+    }
+}
+
+void CpuMonitor::resume()
+{
+    enabled.store(true);
+}
+
+void CpuMonitor::pause()
+{
+    enabled.store(false);
+}
+
+void CpuMonitor::monitorTask()
+{
+    const TickType_t period = pdMS_TO_TICKS(sampleMS);
+    TickType_t lastWake = xTaskGetTickCount();
+    bool wasEnabled = false;
+    int samplesTaken = 0;
+
+    while (true)
+    {
+        if (!enabled.load())
+        {
+            wasEnabled = false;
+            vTaskDelay(pdMS_TO_TICKS(150)); // coarse sleep while paused
+            lastWake = xTaskGetTickCount(); // reset schedule
+            continue;
+        }
+        if (!wasEnabled)
+        {
+            lastWake = xTaskGetTickCount(); // prevent “catch up”
+            wasEnabled = true;
+        }
+
+        sample();
+        // a whole new window every CPU_MONITOR_WINDOW_SAMPLES samples
+        if (++samplesTaken % CPU_MONITOR_WINDOW_SAMPLES == 0)
+        {
+            logReport();
+        }
+
+        vTaskDelayUntil(&lastWake, period);
+    }
+}
+
+void CpuMonitor::sample()
+{
+    if (xSemaphoreTake(samplesMutex, portMAX_DELAY) != pdTRUE)
+        return;
+    int next = (newestSample + 1) % (CPU_MONITOR_WINDOW_SAMPLES + 1);
+    if (readCounters(samples[next]))
+    {
+        newestSample = next;
+        if (sampleCount < CPU_MONITOR_WINDOW_SAMPLES + 1)
+            sampleCount++;
+    }
+    xSemaphoreGive(samplesMutex);
+}
+
+#ifdef ARDUINO
+// the sampling needs uxTaskGetSystemState() and its run-time counters. fail the build rather
+// than report nothing if the core's sdkconfig leaves them out
+#if !configUSE_TRACE_FACILITY || !configGENERATE_RUN_TIME_STATS
+#error "CpuMonitor needs CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS"
+#endif
+
+// every task's run time from the FreeRTOS run-time stats, and each core's idle task's
+bool CpuMonitor::readCounters(Sample &sample)
+{
+    uint32_t totalRunTime = 0;
+    UBaseType_t count = uxTaskGetSystemState(taskStatus, CPU_MONITOR_MAX_TASKS, &totalRunTime);
+    if (count == 0)
+    {
+        static bool logged = false;
+        if (!logged)
+        {
+            Logger::printf("CpuMonitor: more than %d tasks, not sampled\n", CPU_MONITOR_MAX_TASKS);
+            logged = true;
+        }
+        return false;
+    }
+
+    sample.time = totalRunTime; // elapsed time, the run-time clock isn't scaled by the cores
+    sample.coreCount = portNUM_PROCESSORS;
+    for (int core = 0; core < sample.coreCount; core++)
+    {
+        sample.idleTime[core] = 0;
+    }
+    sample.taskCount = 0;
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        TaskStatus_t &status = taskStatus[i];
+        for (int core = 0; core < sample.coreCount; core++)
+        {
+            if (status.xHandle == xTaskGetIdleTaskHandleForCPU(core))
+            {
+                sample.idleTime[core] = (uint32_t)status.ulRunTimeCounter;
+            }
+        }
+
+        TaskSample &task = sample.tasks[sample.taskCount++];
+        task.id = status.xTaskNumber;
+        snprintf(task.name, sizeof(task.name), "%s", status.pcTaskName);
+        BaseType_t affinity = xTaskGetAffinity(status.xHandle);
+        task.core = (affinity == tskNO_AFFINITY) ? -1 : (int)affinity;
+        task.runTime = (uint32_t)status.ulRunTimeCounter;
+        task.switches = 0;
+    }
+    return true;
+}
+#else
+// read the first number after key in a /proc file, 0 if missing
+static unsigned long long readProcValue(const char *path, const char *key)
+{
+    unsigned long long value = 0;
+    FILE *file = fopen(path, "r");
+    if (file == nullptr)
+        return 0;
+    char line[256];
+    size_t keyLength = strlen(key);
+    while (fgets(line, sizeof(line), file) != nullptr)
+    {
+        if (strncmp(line, key, keyLength) == 0)
+        {
+            value = strtoull(line + keyLength, nullptr, 10);
+            break;
+        }
+    }
+    fclose(file);
+    return value;
+}
+
+// every thread of this process from /proc: its CPU time (the scheduler's run time, which its
+// CPU clock reads), its context switches, and the core it's pinned to if just one
+bool CpuMonitor::readCounters(Sample &sample)
+{
+    sample.time = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count();
+
+    // idle jiffies of each core, "cpuN user nice system idle ..."
+    sample.coreCount = 0;
+    FILE *stat = fopen("/proc/stat", "r");
+    if (stat != nullptr)
+    {
+        char line[256];
+        long ticksPerSecond = sysconf(_SC_CLK_TCK);
+        while (fgets(line, sizeof(line), stat) != nullptr && sample.coreCount < CPU_MONITOR_MAX_CORES)
+        {
+            int core;
+            unsigned long long user, nice, system, idle;
+            if (sscanf(line, "cpu%d %llu %llu %llu %llu", &core, &user, &nice, &system, &idle) == 5)
+            {
+                sample.idleTime[sample.coreCount++] = (uint32_t)(idle * 1000000ULL / ticksPerSecond);
+            }
+        }
+        fclose(stat);
+    }
+
+    DIR *dir = opendir("/proc/self/task");
+    if (dir == nullptr)
+        return false;
+    sample.taskCount = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr && sample.taskCount < CPU_MONITOR_MAX_TASKS)
+    {
+        int tid = atoi(entry->d_name);
+        if (tid <= 0)
+            continue;
+        TaskSample &task = sample.tasks[sample.taskCount];
+        char path[64];
+
+        snprintf(path, sizeof(path), "/proc/self/task/%d/schedstat", tid);
+        FILE *file = fopen(path, "r");
+        if (file == nullptr)
+            continue; // the thread has gone
+        unsigned long long runNanos = 0;
+        int read = fscanf(file, "%llu", &runNanos);
+        fclose(file);
+        if (read != 1)
+            continue;
+
+        task.id = (uint32_t)tid;
+        task.runTime = (uint32_t)(runNanos / 1000);
+        snprintf(path, sizeof(path), "/proc/self/task/%d/comm", tid);
+        task.name[0] = '\0';
+        file = fopen(path, "r");
+        if (file != nullptr)
+        {
+            if (fgets(task.name, sizeof(task.name), file) != nullptr)
+                task.name[strcspn(task.name, "\n")] = '\0';
+            fclose(file);
+        }
+        snprintf(path, sizeof(path), "/proc/self/task/%d/status", tid);
+        task.switches = (uint32_t)(readProcValue(path, "voluntary_ctxt_switches:") +
+                                   readProcValue(path, "nonvoluntary_ctxt_switches:"));
+        cpu_set_t cpus;
+        task.core = -1;
+        if (sched_getaffinity(tid, sizeof(cpus), &cpus) == 0 && CPU_COUNT(&cpus) == 1)
+        {
+            for (int core = 0; core < CPU_SETSIZE; core++)
+            {
+                if (CPU_ISSET(core, &cpus))
+                    task.core = core;
+            }
+        }
+        sample.taskCount++;
+    }
+    closedir(dir);
+    return true;
+}
+#endif
+
+void CpuMonitor::getReport(CpuReport &report)
+{
+    report.windowMicros = 0;
+    report.coreCount = 0;
+    report.taskCount = 0;
+    if (xSemaphoreTake(samplesMutex, portMAX_DELAY) != pdTRUE)
+        return;
+    if (sampleCount < 2)
+    {
+        xSemaphoreGive(samplesMutex);
+        return;
+    }
+
+    const int ringSize = CPU_MONITOR_WINDOW_SAMPLES + 1;
+    const Sample &newest = samples[newestSample];
+    const Sample &oldest = samples[(newestSample - (sampleCount - 1) + ringSize) % ringSize];
+    uint32_t window = newest.time - oldest.time;
+    if (window == 0)
+    {
+        xSemaphoreGive(samplesMutex);
+        return;
+    }
+    report.windowMicros = window;
+
+    report.coreCount = newest.coreCount;
+    for (int core = 0; core < report.coreCount; core++)
+    {
+        report.idlePercent[core] = 100.0f * (uint32_t)(newest.idleTime[core] - oldest.idleTime[core]) / window;
+    }
+
+    for (int i = 0; i < newest.taskCount; i++)
+    {
+        const TaskSample &task = newest.tasks[i];
+        // counters at the start of the window. a task created since started from 0
+        const TaskSample *before = nullptr;
+        for (int j = 0; j < oldest.taskCount; j++)
+        {
+            if (oldest.tasks[j].id == task.id)
+            {
+                before = &oldest.tasks[j];
+                break;
+            }
+        }
+        uint32_t runTime = (before != nullptr) ? before->runTime : 0;
+
+        CpuTaskLoad load;
+        snprintf(load.name, sizeof(load.name), "%s", task.name);
+        load.core = task.core;
+        load.percent = 100.0f * (uint32_t)(task.runTime - runTime) / window;
+#ifdef ARDUINO
+        load.switches = -1;
+#else
+        load.switches = (int32_t)(task.switches - ((before != nullptr) ? before->switches : 0));
+#endif
+
+        // busiest first
+        int position = report.taskCount++;
+        while (position > 0 && report.tasks[position - 1].percent < load.percent)
+        {
+            report.tasks[position] = report.tasks[position - 1];
+            position--;
+        }
+        report.tasks[position] = load;
+    }
+    xSemaphoreGive(samplesMutex);
+}
+
+void CpuMonitor::logReport()
+{
+    static CpuReport report; // too big for the stack. only logged from one task at a time
+    getReport(report);
+    if (report.windowMicros == 0)
+        return;
+
+    Logger::printf("CPU (last %lu ms) - Idle:", (unsigned long)(report.windowMicros / 1000));
+    for (int core = 0; core < report.coreCount; core++)
+    {
+        Logger::printf(" core %d %.1f%%", core, report.idlePercent[core]);
+    }
+    Logger::print("\n");
+    // tasks that ran, busiest first
+    for (int i = 0; i < report.taskCount; i++)
+    {
+        const CpuTaskLoad &load = report.tasks[i];
+        if (load.percent < 0.05f)
+            break;
+        char core[12] = "-";
+        if (load.core >= 0)
+            snprintf(core, sizeof(core), "%d", load.core);
+        if (load.switches >= 0)
+            Logger::printf("  %-16s core %s: %5.1f%%, switches %ld\n", load.name, core, load.percent, (long)load.switches);
+        else
+            Logger::printf("  %-16s core %s: %5.1f%%\n", load.name, core, load.percent);
+    }
+}
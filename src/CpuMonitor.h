@@ -0,0 +1,113 @@
+#ifndef CPUMONITOR_H
+#define CPUMONITOR_H
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "Logger.h"
+
+#define CPU_MONITOR_MAX_TASKS 32     // tasks tracked, the rest are left out of the report
+#define CPU_MONITOR_MAX_CORES 8      // ESP32-S3 has 2, more only on host builds
+#define CPU_MONITOR_SAMPLE_MS 1000   // time between samples
+#define CPU_MONITOR_WINDOW_SAMPLES 5 // samples the sliding window spans, logged once per window
+#define CPU_MONITOR_CORE 0           // off the display core
+
+// cpu use of one task over the window
+struct CpuTaskLoad
+{
+    char name[16];
+    int core;          // core it's pinned to, -1 if it can run on either
+    float percent;     // of one core's time
+    int32_t switches;  // times it was switched in, host builds only, -1 on target
+};
+
+// cpu use of every task and the idle share of each core, over the window
+struct CpuReport
+{
+    uint32_t windowMicros; // time the report covers, 0 until there are two samples
+    int coreCount;
+    float idlePercent[CPU_MONITOR_MAX_CORES];
+    int taskCount;
+    CpuTaskLoad tasks[CPU_MONITOR_MAX_TASKS];
+};
+
+// Per-task CPU accounting, for checking which core and priority each task should have.
+// A low priority task samples each task's run time every CPU_MONITOR_SAMPLE_MS into a ring,
+// so a report covers the last CPU_MONITOR_WINDOW_SAMPLES samples as a sliding window.
+// On target the run times come from the FreeRTOS run-time stats (uxTaskGetSystemState),
+// and a core's idle share from its idle task. The build fails if the core's FreeRTOS has
+// configUSE_TRACE_FACILITY or configGENERATE_RUN_TIME_STATS off.
+// Per-task context switch counts are host only: FreeRTOS doesn't count them, so on target
+// every task's switches is -1 and the report leaves them out.
+// On host builds every thread of the process is sampled from /proc: run time from its CPU
+// clock, switches from the kernel's voluntary + involuntary counts, and idle from /proc/stat.
+// All times are µs, the same as the frame time histograms.
+// Usage:
+//     CpuMonitor cpuMonitor;
+//     cpuMonitor.resume();        // start sampling, logs a report every window
+//     CpuReport report;
+//     cpuMonitor.getReport(report);
+class CpuMonitor
+{
+public:
+    CpuMonitor(int sampleMS = CPU_MONITOR_SAMPLE_MS);
+    ~CpuMonitor();
+
+    // start and stop the background sampling task
+    void resume();
+    void pause();
+
+    // take a sample now. the sampling task calls this every sampleMS
+    void sample();
+
+    // cpu use between the oldest and the newest sample. safe from any task
+    void getReport(CpuReport &report);
+    void logReport();
+
+private:
+    // one task's counters at a sample
+    struct TaskSample
+    {
+        uint32_t id; // FreeRTOS task number, or thread id on host
+        char name[16];
+        int core;
+        uint32_t runTime; // µs
+        uint32_t switches;
+    };
+    // every task's counters at one time
+    struct Sample
+    {
+        uint32_t time; // µs
+        int coreCount;
+        uint32_t idleTime[CPU_MONITOR_MAX_CORES]; // µs
+        int taskCount;
+        TaskSample tasks[CPU_MONITOR_MAX_TASKS];
+    };
+
+    int sampleMS;
+    std::atomic<bool> enabled;
+
+    // ring of the last samples, oldest to newest. protected by samplesMutex
+    Sample samples[CPU_MONITOR_WINDOW_SAMPLES + 1];
+    int newestSample = 0;
+    int sampleCount = 0;
+    SemaphoreHandle_t samplesMutex;
+
+    // fill in the counters as they are now. false if they can't be read
+    bool readCounters(Sample &sample);
+#ifdef ARDUINO
+    TaskStatus_t taskStatus[CPU_MONITOR_MAX_TASKS]; // for readCounters(), too big for the stack
+#endif
+
+    TaskHandle_t monitorTaskHandle = NULL;
+    // the sampling task function
+    void monitorTask();
+    // a static function wrapper we can use as a task function
+    static void monitorTaskWrapper(void *params)
+    {
+        static_cast<CpuMonitor *>(params)->monitorTask();
+    }
+};
+
+#endif
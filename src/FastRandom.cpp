@@ -0,0 +1,47 @@
+#include "FastRandom.h"
+
+// expand the 32-bit seed into the 128-bit state with splitmix64
+void FastRandom::seed(uint32_t seed)
+{
+    uint64_t x = seed;
+    for (int i = 0; i < 4; i += 2)
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        uint64_t z = x;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z = z ^ (z >> 31);
+        state[i] = (uint32_t)z;
+        state[i + 1] = (uint32_t)(z >> 32);
+    }
+    // xoshiro must not start from an all-zero state
+    if ((state[0] | state[1] | state[2] | state[3]) == 0)
+        state[0] = 1;
+}
+
+// Each lane compares its own uniform 16-bit random number against the probability, one
+// bit at a time from the most significant end: a lane is decided as soon as its random
+// bit differs from the probability bit. All 32 lanes are compared in parallel, and we
+// stop once every lane is decided, which takes ~7 random words for 32 lanes.
+uint32_t FastRandom::bernoulliMask(uint16_t probability, uint32_t lanes)
+{
+    uint32_t result = 0;
+    uint32_t undecided = lanes;
+    for (int bit = 15; bit >= 0 && undecided; bit--)
+    {
+        uint32_t r = next();
+        if (probability & (1u << bit))
+        {
+            // random bit 0 where probability bit is 1: random number < probability
+            result |= undecided & ~r;
+            undecided &= r;
+        }
+        else
+        {
+            // random bit 1 where probability bit is 0: random number > probability
+            undecided &= ~r;
+        }
+    }
+    // lanes still undecided drew exactly the probability, so are not below it
+    return result;
+}
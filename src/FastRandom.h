@@ -0,0 +1,60 @@
+#ifndef FASTRANDOM_H
+#define FASTRANDOM_H
+
+#pragma once
+
+#include <Arduino.h>
+
+// Small seeded pseudo-random generator (xoshiro128**) for the render path.
+// Much cheaper than Arduino random(), which does a modulo and a libc call per number,
+// and reproducible: the same seed always gives the same sequence.
+// bernoulliMask() gives 32 independent random bits at once, each set with a given
+// probability, so chance-based cell updates can be done a whole column at a time.
+// Usage:
+//     FastRandom rng(1234);
+//     uint32_t r = rng.next();
+//     uint32_t die = rng.bernoulliMask(FastRandom::probability(99, 100)); // ~99% of bits set
+//     alive &= ~die;
+class FastRandom
+{
+public:
+    FastRandom(uint32_t seed = 0x9E3779B9) { this->seed(seed); }
+
+    // restart the sequence from the given seed
+    void seed(uint32_t seed);
+
+    // next 32 random bits
+    uint32_t next()
+    {
+        uint32_t result = rotl(state[1] * 5, 7) * 9;
+        uint32_t t = state[1] << 9;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 11);
+        return result;
+    }
+
+    // random number in range 0 to bound-1, without a modulo
+    uint32_t nextBelow(uint32_t bound) { return (uint32_t)(((uint64_t)next() * bound) >> 32); }
+
+    // convert a chance of numerator/denominator to a probability in 1/65536ths for bernoulliMask()
+    static uint16_t probability(uint32_t numerator, uint32_t denominator)
+    {
+        uint32_t p = (numerator * 65536u) / denominator;
+        return (p > 0xFFFF) ? 0xFFFF : p;
+    }
+
+    // 32 random bits, each set with the given probability (in 1/65536ths).
+    // only bits in 'lanes' are drawn, the rest are 0. the fewer lanes, the cheaper this is.
+    uint32_t bernoulliMask(uint16_t probability, uint32_t lanes = 0xFFFFFFFF);
+
+private:
+    uint32_t state[4];
+
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "FrameBuffer.h"
+
+// set every pixel to value
+template <class Pixel>
+void BasicFrameBuffer<Pixel>::fill(Pixel value)
+{
+    for (int y = 0; y < HEIGHT; y++)
+    {
+        pixels[y].fill(value);
+    }
+}
+
+// the pixel formats in use
+template class BasicFrameBuffer<uint16_t>;
+template class BasicFrameBuffer<uint8_t>;
+
+const int FrameView::PALETTE_SIZE;
+
+// colours of a span of a row, copied or looked up in the palette
+void FrameView::readSpan(int x, int y, int count, uint16_t *dest) const
+{
+    if (format == FRAME_FORMAT_RGB565)
+    {
+        memcpy(dest, colors->span(x, y), count * sizeof(uint16_t));
+        return;
+    }
+
+    // no palette yet, so nothing to show
+    if (palette == nullptr)
+    {
+        memset(dest, 0, count * sizeof(uint16_t));
+        return;
+    }
+    const uint8_t *source = indices->span(x, y);
+    for (int i = 0; i < count; i++)
+    {
+        dest[i] = palette[source[i]];
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+
+// Row-major frame of pixels: RGB565 colours (FrameBuffer) or 8-bit palette indices (IndexFrameBuffer).
+// The pixels of each row are contiguous, in the order the HUB75 panel scans them, so a
+// whole row (or a span of one) can be walked, blended or uploaded through one pointer.
+// Rows are 4-byte aligned for ColorMath's two-pixels-per-word row functions.
+// Usage:
+//     FrameBuffer frame;
+//     frame.at(x, y) = color;
+//     const uint16_t *pixels = frame.row(y); // WIDTH pixels
+//     uint16_t *tileRow = frame.span(x, y);  // pixels x.. of row y
+template <class Pixel>
+class BasicFrameBuffer
+{
+public:
+    static const int WIDTH = 64;
+    static const int HEIGHT = 32;
+    static_assert((WIDTH * sizeof(Pixel)) % 4 == 0, "FrameBuffer rows must stay 4-byte aligned");
+
+    Pixel &at(int x, int y) { return pixels[y][x]; }
+    Pixel at(int x, int y) const { return pixels[y][x]; }
+
+    // pointer to the WIDTH pixels of row y
+    Pixel *row(int y) { return pixels[y].data(); }
+    const Pixel *row(int y) const { return pixels[y].data(); }
+
+    // pointer to the pixels of row y from x onwards
+    Pixel *span(int x, int y) { return &pixels[y][x]; }
+    const Pixel *span(int x, int y) const { return &pixels[y][x]; }
+
+    // set every pixel to value
+    void fill(Pixel value);
+
+private:
+    alignas(4) std::array<std::array<Pixel, WIDTH>, HEIGHT> pixels;
+};
+
+template <class Pixel>
+const int BasicFrameBuffer<Pixel>::WIDTH;
+template <class Pixel>
+const int BasicFrameBuffer<Pixel>::HEIGHT;
+
+// RGB565 colours, what the panel shows
+typedef BasicFrameBuffer<uint16_t> FrameBuffer;
+// 8-bit palette indices, turned into colours with a 256-entry RGB565 palette
+typedef BasicFrameBuffer<uint8_t> IndexFrameBuffer;
+
+// how a frame stores its pixels
+enum FrameFormat
+{
+    FRAME_FORMAT_RGB565,  // 16-bit colours, a FrameBuffer
+    FRAME_FORMAT_INDEXED8 // 8-bit palette indices, an IndexFrameBuffer and its palette
+};
+
+// Read-only view of a frame in either format, e.g. a matrix's current frame or a queued one.
+// Rows are read out as RGB565 colours, looked up in the palette for indexed frames,
+// so a reader needn't know the format. Only valid while the frame isn't written to.
+// A view of no frame (the default) has no pixels to read, see isEmpty().
+// Usage:
+//     FrameView frame = matrix->getFrame();
+//     frame.readRow(y, colors); // FrameBuffer::WIDTH colours
+struct FrameView
+{
+    static const int PALETTE_SIZE = 256; // colours of an indexed frame's palette
+
+    FrameFormat format = FRAME_FORMAT_RGB565;
+    const FrameBuffer *colors = nullptr;      // FRAME_FORMAT_RGB565 only
+    const IndexFrameBuffer *indices = nullptr; // FRAME_FORMAT_INDEXED8 only
+    const uint16_t *palette = nullptr;         // FRAME_FORMAT_INDEXED8: PALETTE_SIZE colours, null if none yet
+
+    FrameView() {}
+    FrameView(const FrameBuffer *colors) : format(FRAME_FORMAT_RGB565), colors(colors) {}
+    FrameView(const IndexFrameBuffer *indices, const uint16_t *palette)
+        : format(FRAME_FORMAT_INDEXED8), indices(indices), palette(palette) {}
+
+    // whether there's no frame to read
+    bool isEmpty() const { return (format == FRAME_FORMAT_RGB565) ? colors == nullptr : indices == nullptr; }
+    // same frame, and for indexed frames the same palette
+    bool operator==(const FrameView &other) const
+    {
+        return format == other.format && colors == other.colors && indices == other.indices && palette == other.palette;
+    }
+    bool operator!=(const FrameView &other) const { return !(*this == other); }
+
+    // write the colours of pixels x..x+count-1 of row y to dest. black if there's no palette
+    void readSpan(int x, int y, int count, uint16_t *dest) const;
+    // write the FrameBuffer::WIDTH colours of row y to dest
+    void readRow(int y, uint16_t *dest) const { readSpan(0, y, FrameBuffer::WIDTH, dest); }
+};
+
+#endif
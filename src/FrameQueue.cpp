@@ -0,0 +1,97 @@
+#include "FrameQueue.h"
+
+// RGB565 frames are copied whole, indexed frames as their indices and palette
+void QueuedFrame::write(const FrameView &frame)
+{
+    format = frame.format;
+    if (format == FRAME_FORMAT_RGB565)
+    {
+        colors = *frame.colors;
+        return;
+    }
+    indexed.indices = *frame.indices;
+    indexed.hasPalette = (frame.palette != nullptr);
+    if (indexed.hasPalette)
+        memcpy(indexed.palette, frame.palette, sizeof(indexed.palette));
+}
+
+FrameView QueuedFrame::view() const
+{
+    if (format == FRAME_FORMAT_RGB565)
+        return FrameView(&colors);
+    return FrameView(&indexed.indices, indexed.hasPalette ? indexed.palette : nullptr);
+}
+
+FrameQueue::FrameQueue()
+{
+    writeCount.store(0);
+    readCount.store(0);
+    producerStalls.store(0);
+    consumerStalls.store(0);
+    for (int i = 0; i < SLOTS; i++)
+    {
+        slots[i].colors.fill(0);
+        slotGenerations[i] = 0;
+    }
+}
+
+QueuedFrame *FrameQueue::beginWrite()
+{
+    uint32_t written = writeCount.load(std::memory_order_relaxed);
+    uint32_t read = readCount.load(std::memory_order_acquire);
+    if (written - read >= (uint32_t)SLOTS)
+    {
+        producerStalls.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return &slots[written % SLOTS];
+}
+
+void FrameQueue::commitWrite(uint32_t generation)
+{
+    uint32_t written = writeCount.load(std::memory_order_relaxed);
+    slotGenerations[written % SLOTS] = generation;
+    writeCount.store(written + 1, std::memory_order_release);
+}
+
+const QueuedFrame *FrameQueue::nextFrame(uint32_t generation, bool *isNew)
+{
+    uint32_t read = readCount.load(std::memory_order_relaxed);
+    uint32_t written = writeCount.load(std::memory_order_acquire);
+    bool advanced = false;
+
+    // release the frame on show if there is a newer one, and drop frames of older generations
+    while (written - read > (showing ? 1u : 0u))
+    {
+        if (showing)
+        {
+            read++;
+            showing = false;
+        }
+        if (slotGenerations[read % SLOTS] == generation)
+        {
+            showing = true;
+            advanced = true;
+        }
+        else
+        {
+            read++;
+        }
+        readCount.store(read, std::memory_order_release);
+        if (advanced)
+            break;
+    }
+
+    if (!advanced)
+        consumerStalls.fetch_add(1, std::memory_order_relaxed);
+    if (isNew != nullptr)
+        *isNew = advanced;
+    return showing ? &slots[read % SLOTS] : nullptr;
+}
+
+int FrameQueue::getDepth() const
+{
+    uint32_t written = writeCount.load(std::memory_order_acquire);
+    uint32_t read = readCount.load(std::memory_order_acquire);
+    return (int)(written - read) - (showing ? 1 : 0);
+}
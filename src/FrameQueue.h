@@ -0,0 +1,91 @@
+#ifndef FRAMEQUEUE_H
+#define FRAMEQUEUE_H
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "FrameBuffer.h"
+
+#define FRAME_QUEUE_SLOTS 3 // one frame on show plus up to two computed ahead
+
+// One slot of the queue: RGB565 colours, or palette indices with the palette they index.
+// An indexed frame only fills its indices and its copy of the palette (2.5 KB of the slot),
+// and is looked up by whoever reads it through view(), e.g. as the frame is composed.
+// The palette is copied with the frame, so the matrix can change its own while it's shown.
+struct QueuedFrame
+{
+    struct IndexedFrame
+    {
+        IndexFrameBuffer indices;
+        alignas(4) uint16_t palette[FrameView::PALETTE_SIZE];
+        bool hasPalette; // no palette yet, so nothing to show
+    };
+
+    FrameFormat format = FRAME_FORMAT_RGB565;
+    union
+    {
+        FrameBuffer colors;   // FRAME_FORMAT_RGB565
+        IndexedFrame indexed; // FRAME_FORMAT_INDEXED8
+    };
+
+    QueuedFrame() {}
+
+    // copy a frame in, in its own format
+    void write(const FrameView &frame);
+    // the frame as it was written
+    FrameView view() const;
+};
+
+// Lock-free single-producer/single-consumer queue of finished frames.
+// The slots are pre-allocated QueuedFrames: the producer renders into the next free slot
+// and commits it, the consumer shows the committed frames in order, one per nextFrame().
+// The frame on show keeps its slot until the next one is ready, so the consumer always has
+// something to show. Frames are never skipped to catch up.
+// Each frame carries a generation number; frames from an older generation (e.g. rendered
+// by a matrix that has since been switched out) are dropped by the consumer.
+// Only std::atomic is used, so it can be tested on a host with std::thread.
+// Usage:
+//     // producer
+//     QueuedFrame *slot = queue.beginWrite();
+//     if (slot) { slot->write(matrix->getFrame()); queue.commitWrite(generation); }
+//     // consumer
+//     const QueuedFrame *frame = queue.nextFrame(generation);
+class FrameQueue
+{
+public:
+    static const int SLOTS = FRAME_QUEUE_SLOTS;
+
+    FrameQueue();
+
+    // producer: the slot to render the next frame into, or null if the queue is full
+    QueuedFrame *beginWrite();
+    // producer: publish the slot from beginWrite()
+    void commitWrite(uint32_t generation);
+
+    // consumer: the frame to show now. moves on to the next finished frame of this generation
+    // if there is one, otherwise keeps the current one. null if there is nothing to show yet.
+    // isNew, if given, is set to whether it moved on to a new frame
+    const QueuedFrame *nextFrame(uint32_t generation, bool *isNew = nullptr);
+
+    // consumer: committed frames not yet shown
+    int getDepth() const;
+    // times the producer found the queue full / the consumer found no new frame
+    uint32_t getProducerStalls() const { return producerStalls.load(std::memory_order_relaxed); }
+    uint32_t getConsumerStalls() const { return consumerStalls.load(std::memory_order_relaxed); }
+
+private:
+    QueuedFrame slots[SLOTS];
+    uint32_t slotGenerations[SLOTS];
+
+    // free-running counts: frames committed by the producer / released by the consumer
+    std::atomic<uint32_t> writeCount;
+    std::atomic<uint32_t> readCount;
+
+    bool showing = false; // consumer: the slot at readCount is the frame on show
+
+    std::atomic<uint32_t> producerStalls;
+    std::atomic<uint32_t> consumerStalls;
+};
+
+#endif
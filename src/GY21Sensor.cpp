@@ -7,6 +7,7 @@ GY21Sensor::GY21Sensor(int sda, int scl, int updateIntervalMS)
     this->prevTemp.store(-1000.0f);     // unrealistic initial value
     this->prevHumidity.store(-1000.0f); // unrealistic initial value
     this->valueChanged.store(true);
+    this->changeListener.store(NULL);
     snprintf(temperatureString, sizeof(temperatureString), "00.0*");
     snprintf(humidityString, sizeof(humidityString), "00%%");
 
@@ -74,6 +75,12 @@ void GY21Sensor::updateTask()
 
         // if enabled, read sensor, update values, create strings
         readSensor();
+        // wake whoever is waiting for a change
+        TaskHandle_t listener = changeListener.load();
+        if (listener != NULL && valueChanged.load())
+        {
+            xTaskNotifyGive(listener);
+        }
 
         // stable frame pacing
         vTaskDelayUntil(&lastWake, period);
@@ -83,6 +90,7 @@ void GY21Sensor::updateTask()
 // read sensor, update values if changed and create strings
 void GY21Sensor::readSensor()
 {
+    TRACE_ZONE("Read sensor");
     if (gy21.read())
     {
         float newTemp = gy21.getTemperature() + CALIBRATION_OFFSET_TEMP; // apply calibration offset
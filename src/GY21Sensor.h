@@ -8,6 +8,7 @@
 #include <Arduino.h>
 #include <atomic>
 #include "Logger.h"
+#include "Trace.h"
 
 #define CALIBRATION_OFFSET_TEMP -1.0f // empirically determined offset to calibrate temperature readings
 
@@ -31,6 +32,8 @@ public:
 
     // has value changed since last read?. then reset flag
     bool hasValueChanged() { return valueChanged.exchange(false); }
+    // task to notify (xTaskNotifyGive) when a value changes, so it can wait for changes. NULL for none
+    void setChangeListener(TaskHandle_t task) { changeListener.store(task); }
 
     // get temperature and humidity strings safely to provided buffers
     void getTemperatureString(char *buffer, size_t bufferSize);
@@ -50,6 +53,7 @@ private:
     std::atomic<float> prevTemp;
     std::atomic<float> prevHumidity;
     std::atomic<bool> valueChanged;
+    std::atomic<TaskHandle_t> changeListener;
 
     const float MIN_TEMP_CHANGE = 0.1f;         // minimum change in temperature to register as updated
     const float MIN_HUMIDITY_CHANGE = 1.0f;     // minimum change in humidity to register as updated
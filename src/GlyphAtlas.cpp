@@ -0,0 +1,155 @@
+#include "GlyphAtlas.h"
+
+GlyphAtlas::GlyphAtlas(Glyph *glyphs, int maxGlyphs, uint32_t *rows, int maxRows)
+    : glyphs(glyphs), maxGlyphs(maxGlyphs), rows(rows), maxRows(maxRows)
+{
+    clear();
+}
+
+void GlyphAtlas::clear()
+{
+    memset(slots, NO_GLYPH, sizeof(slots));
+    glyphCount = 0;
+    rowCount = 0;
+}
+
+// decode the charset's glyphs. characters the font doesn't have are left out
+bool GlyphAtlas::build(const GFXfont *font, const char *charset)
+{
+    clear();
+    this->font = font;
+    if (font == nullptr)
+        return false;
+    yAdvance = pgm_read_byte(&font->yAdvance);
+
+    uint8_t first = pgm_read_byte(&font->first);
+    uint8_t last = pgm_read_byte(&font->last);
+    if (charset == nullptr)
+    {
+        for (int c = first; c <= last; c++)
+        {
+            if (!addGlyph(c))
+                return false;
+        }
+        return true;
+    }
+    for (const char *c = charset; *c != '\0'; c++)
+    {
+        uint8_t ch = (uint8_t)*c;
+        if (ch < first || ch > last || slots[ch] != NO_GLYPH)
+            continue;
+        if (!addGlyph(ch))
+            return false;
+    }
+    return true;
+}
+
+// glyph bitmaps are packed a bit per pixel, most significant bit first, with rows
+// following on without padding. each row is unpacked into its own word
+bool GlyphAtlas::addGlyph(uint8_t c)
+{
+    const GFXglyph *fontGlyph = &((const GFXglyph *)pgm_read_pointer(&font->glyph))[c - pgm_read_byte(&font->first)];
+    uint8_t w = pgm_read_byte(&fontGlyph->width);
+    uint8_t h = pgm_read_byte(&fontGlyph->height);
+    if (glyphCount >= maxGlyphs || rowCount + h > maxRows || w > GLYPH_ATLAS_MAX_WIDTH)
+    {
+        Logger::printf("GlyphAtlas: glyph 0x%02X doesn't fit\n", c);
+        return false;
+    }
+
+    Glyph &glyph = glyphs[glyphCount];
+    glyph.firstRow = rowCount;
+    glyph.width = w;
+    glyph.height = h;
+    glyph.xAdvance = pgm_read_byte(&fontGlyph->xAdvance);
+    glyph.xOffset = (int8_t)pgm_read_byte(&fontGlyph->xOffset);
+    glyph.yOffset = (int8_t)pgm_read_byte(&fontGlyph->yOffset);
+
+    const uint8_t *bitmap = (const uint8_t *)pgm_read_pointer(&font->bitmap);
+    uint16_t offset = pgm_read_word(&fontGlyph->bitmapOffset);
+    uint8_t bits = 0;
+    int bit = 0;
+    for (int yy = 0; yy < h; yy++)
+    {
+        uint32_t row = 0;
+        for (int xx = 0; xx < w; xx++)
+        {
+            if (!(bit++ & 7))
+                bits = pgm_read_byte(&bitmap[offset++]);
+            if (bits & 0x80)
+                row |= (uint32_t)1 << xx;
+            bits <<= 1;
+        }
+        rows[rowCount++] = row;
+    }
+
+    slots[c] = glyphCount++;
+    return true;
+}
+
+// follows Adafruit_GFX::getTextBounds() and charBounds() at text size 1, wrapping at the panel width
+void GlyphAtlas::getTextBounds(const char *text, int16_t x, int16_t y,
+                               int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h) const
+{
+    int16_t minX = 0x7FFF, minY = 0x7FFF, maxX = -1, maxY = -1;
+    *x1 = x;
+    *y1 = y;
+    *w = 0;
+    *h = 0;
+    for (const char *c = text; *c != '\0'; c++)
+    {
+        if (*c == '\n')
+        {
+            x = 0;
+            y += yAdvance;
+            continue;
+        }
+        const Glyph *glyph = find(*c);
+        if (glyph == nullptr)
+            continue;
+        if (x + glyph->xOffset + glyph->width > FrameBuffer::WIDTH)
+        {
+            x = 0;
+            y += yAdvance;
+        }
+        int16_t left = x + glyph->xOffset;
+        int16_t top = y + glyph->yOffset;
+        int16_t right = left + glyph->width - 1;
+        int16_t bottom = top + glyph->height - 1;
+        if (left < minX)
+            minX = left;
+        if (top < minY)
+            minY = top;
+        if (right > maxX)
+            maxX = right;
+        if (bottom > maxY)
+            maxY = bottom;
+        x += glyph->xAdvance;
+    }
+    if (maxX >= minX)
+    {
+        *x1 = minX;
+        *w = maxX - minX + 1;
+    }
+    if (maxY >= minY)
+    {
+        *y1 = minY;
+        *h = maxY - minY + 1;
+    }
+}
+
+int GlyphAtlas::getTextWidth(const char *text) const
+{
+    int16_t x1, y1;
+    uint16_t w, h;
+    getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
+    return w;
+}
+
+int GlyphAtlas::getTextHeight(const char *text) const
+{
+    int16_t x1, y1;
+    uint16_t w, h;
+    getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
+    return h;
+}
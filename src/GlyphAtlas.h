@@ -0,0 +1,108 @@
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#pragma once
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "FrameBuffer.h"
+#include "Logger.h"
+
+#define GLYPH_ATLAS_MAX_WIDTH 32 // a glyph row is one 32-bit word
+
+// The glyphs of a GFXfont decoded once into row-aligned bitmasks, with their metrics.
+// Each glyph row is a word with bit i set if pixel i from the glyph's left edge is drawn,
+// the same bit order as TextMask rows, so a glyph row is drawn with one shift and OR.
+// Only the glyphs in a charset are decoded e.g. the digits and symbols the sensor texts
+// use. Characters outside the charset are skipped, as GFX skips those outside the font.
+// Storage is fixed by FixedGlyphAtlas' template parameters, nothing is allocated.
+// Text is measured from the atlas metrics exactly as Adafruit_GFX::getTextBounds() does,
+// without building a String.
+// Usage:
+//     #define DIGITS "0123456789"
+//     FixedGlyphAtlas<GlyphAtlas::charsetSize(DIGITS)> atlas;
+//     atlas.build(&FreeMonoBold12pt7b, DIGITS);
+//     int width = atlas.getTextWidth("42");
+//     mask.render("42", atlas, x, y);
+class GlyphAtlas
+{
+public:
+    // a decoded glyph. its rows are getRows(glyph)[0..height-1]
+    struct Glyph
+    {
+        uint16_t firstRow; // index of the glyph's first row in the atlas rows
+        uint8_t width;
+        uint8_t height;
+        uint8_t xAdvance;
+        int8_t xOffset; // from the cursor to the glyph's left edge
+        int8_t yOffset; // from the baseline to the glyph's top edge
+    };
+
+    // number of characters in a charset, for sizing a FixedGlyphAtlas at compile time
+    static constexpr int charsetSize(const char *charset)
+    {
+        return *charset == '\0' ? 0 : 1 + charsetSize(charset + 1);
+    }
+
+    // decode the glyphs of font in charset (every glyph in the font if nullptr).
+    // returns false if they didn't fit the atlas, or one is wider than GLYPH_ATLAS_MAX_WIDTH
+    bool build(const GFXfont *font, const char *charset = nullptr);
+
+    // the glyph for c, nullptr if it isn't in the atlas
+    const Glyph *find(char c) const
+    {
+        uint8_t slot = slots[(uint8_t)c];
+        return slot == NO_GLYPH ? nullptr : &glyphs[slot];
+    }
+    const uint32_t *getRows(const Glyph &glyph) const { return rows + glyph.firstRow; }
+
+    const GFXfont *getFont() const { return font; }
+    uint8_t getYAdvance() const { return yAdvance; }
+
+    // bounds of text printed with the cursor at (x,y), as Adafruit_GFX::getTextBounds()
+    void getTextBounds(const char *text, int16_t x, int16_t y,
+                       int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h) const;
+    int getTextWidth(const char *text) const;
+    int getTextHeight(const char *text) const;
+
+    // bytes of glyph and row storage in use, for logging
+    int getUsedBytes() const { return glyphCount * sizeof(Glyph) + rowCount * sizeof(uint32_t); }
+
+protected:
+    // storage comes from FixedGlyphAtlas
+    GlyphAtlas(Glyph *glyphs, int maxGlyphs, uint32_t *rows, int maxRows);
+
+private:
+    static const uint8_t NO_GLYPH = 0xFF;
+
+    Glyph *glyphs;
+    int maxGlyphs;
+    uint32_t *rows;
+    int maxRows;
+
+    const GFXfont *font = nullptr;
+    uint8_t yAdvance = 0;
+    int glyphCount = 0;
+    int rowCount = 0;
+    uint8_t slots[256]; // glyph index of each character, NO_GLYPH if none
+
+    void clear();
+    // decode character c of the font into the next glyph. false if it doesn't fit
+    bool addGlyph(uint8_t c);
+};
+
+// a GlyphAtlas holding up to MAX_GLYPHS glyphs of up to MAX_ROWS rows in total
+template <int MAX_GLYPHS, int MAX_ROWS = MAX_GLYPHS * FrameBuffer::HEIGHT>
+class FixedGlyphAtlas : public GlyphAtlas
+{
+public:
+    static_assert(MAX_GLYPHS > 0 && MAX_GLYPHS < 256, "glyph indices are one byte");
+
+    FixedGlyphAtlas() : GlyphAtlas(glyphStorage, MAX_GLYPHS, rowStorage, MAX_ROWS) {}
+
+private:
+    Glyph glyphStorage[MAX_GLYPHS];
+    uint32_t rowStorage[MAX_ROWS];
+};
+
+#endif
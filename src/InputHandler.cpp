@@ -91,6 +91,7 @@ void InputHandler::pollingTask()
     {
         if (pollingEnabled.load())
         {
+            TRACE_ZONE("Poll inputs");
             // we use temporary variables to hold current frequency components
             uint8_t tempBright;
             uint16_t tempHue;
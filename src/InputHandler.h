@@ -6,6 +6,7 @@
 #include <Arduino.h>
 #include "RotaryEncoder.h"
 #include "Logger.h"
+#include "Trace.h"
 #include "MODES.h"
 
 // MIN/MAX ADC values(0-4095) for ldr thresholds - determined experimentally
@@ -0,0 +1,148 @@
+#include "JobSystem.h"
+
+JobSystem::JobSystem(int workerCount, int firstCore, bool workStealing)
+{
+    this->workerCount = constrain(workerCount, 0, JOB_SYSTEM_MAX_WORKERS);
+    this->workStealing = workStealing;
+    this->batch.store(0);
+    this->function.store(nullptr);
+    this->context.store(nullptr);
+    this->jobsRemaining.store(0);
+    this->stolenJobs.store(0);
+    for (int i = 0; i <= JOB_SYSTEM_MAX_WORKERS; i++)
+    {
+        shares[i].store(0); // batch 0, no jobs
+    }
+
+    batchDone = xSemaphoreCreateBinary();
+    if (batchDone == NULL)
+    {
+        Logger::println("ERROR: Failed to create JobSystem batchDone semaphore");
+        this->workerCount = 0; // jobs will run on the calling task only
+    }
+
+    // create the persistent worker tasks, one per core from firstCore on
+    for (int i = 0; i < this->workerCount; i++)
+    {
+        workers[i].jobSystem = this;
+        workers[i].index = i + 1;
+        workers[i].taskHandle = NULL;
+        xTaskCreatePinnedToCore(
+            JobSystem::workerTaskWrapper,          // Function that should be called
+            "Job Worker",                          // Name of the task (for debugging)
+            JOB_WORKER_STACK,                      // Stack size (bytes)
+            &workers[i],                           // Parameter to pass
+            JOB_WORKER_PRIORITY,                   // Task priority
+            &workers[i].taskHandle,                // Task handle
+            (firstCore + i) % portNUM_PROCESSORS); // Core to run the task on
+        if (workers[i].taskHandle == NULL)
+        {
+            Logger::printf("Failed to create JobSystem worker %d\n", i);
+            this->workerCount = i;
+            break;
+        }
+    }
+    participants = this->workerCount + 1;
+}
+
+// run function(context, job) for every job, spread across the workers and this task
+void JobSystem::run(int jobCount, JobFunction function, void *context)
+{
+    // nothing to share out, or too many jobs to track: run them all here
+    if (workerCount == 0 || jobCount <= 1 || jobCount > JOB_SYSTEM_MAX_JOBS)
+    {
+        for (int job = 0; job < jobCount; job++)
+        {
+            function(context, job);
+        }
+        return;
+    }
+
+    // set up the batch: each participant gets an equal, contiguous share of the jobs
+    uint32_t batchId = (batch.load(std::memory_order_relaxed) + 1) & 0xFFFF;
+    this->function.store(function, std::memory_order_relaxed);
+    this->context.store(context, std::memory_order_relaxed);
+    jobsRemaining.store(jobCount, std::memory_order_relaxed);
+    for (int p = 0; p < participants; p++)
+    {
+        uint32_t start = jobCount * p / participants;
+        uint32_t end = jobCount * (p + 1) / participants;
+        shares[p].store((batchId << 16) | (end << 8) | start, std::memory_order_relaxed);
+    }
+    batch.store(batchId, std::memory_order_release);
+
+    // wake the workers and do our own share meanwhile
+    for (int i = 0; i < workerCount; i++)
+    {
+        xTaskNotifyGive(workers[i].taskHandle);
+    }
+    runShare(batchId, 0);
+
+    // barrier: wait for the jobs still running on the workers
+    xSemaphoreTake(batchDone, portMAX_DELAY);
+}
+
+// run the participant's own share of the batch, then help with the others' if stealing
+void JobSystem::runShare(uint32_t batchId, int participant)
+{
+    JobFunction jobFunction = function.load(std::memory_order_relaxed);
+    void *jobContext = context.load(std::memory_order_relaxed);
+
+    for (int i = 0; i < participants; i++)
+    {
+        if (i > 0 && !workStealing)
+            break;
+        int share = (participant + i) % participants;
+        int job;
+        while ((job = claimJob(share, batchId)) >= 0)
+        {
+            {
+                TRACE_ZONE("Job");
+                jobFunction(jobContext, job);
+            }
+            if (i > 0)
+                stolenJobs.fetch_add(1, std::memory_order_relaxed);
+            // the last job to finish releases run()
+            if (jobsRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                xSemaphoreGive(batchDone);
+        }
+    }
+}
+
+// claim the next job of a share
+int JobSystem::claimJob(int share, uint32_t batchId)
+{
+    uint32_t value = shares[share].load(std::memory_order_acquire);
+    while (true)
+    {
+        uint32_t next = value & 0xFF;
+        uint32_t end = (value >> 8) & 0xFF;
+        if ((value >> 16) != batchId || next >= end)
+            return -1;
+        if (shares[share].compare_exchange_weak(value, value + 1, std::memory_order_acq_rel,
+                                                std::memory_order_acquire))
+            return next;
+    }
+}
+
+// the worker task function: sleeps until run() has a batch, then helps with it
+void JobSystem::workerTask(int index)
+{
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        runShare(batch.load(std::memory_order_acquire), index);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    for (int i = 0; i < workerCount; i++)
+    {
+        vTaskDelete(workers[i].taskHandle);
+    }
+    if (batchDone != NULL)
+    {
+        vSemaphoreDelete(batchDone);
+    }
+}
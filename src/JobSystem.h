@@ -0,0 +1,88 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "Logger.h"
+#include "Trace.h"
+
+#define JOB_SYSTEM_MAX_WORKERS 4 // persistent worker tasks, not counting the task calling run()
+#define JOB_SYSTEM_MAX_JOBS 64   // jobs per run() call
+#define JOB_WORKER_PRIORITY 1    // same as the frame producer, below the display task
+#define JOB_WORKER_STACK 4096    // worker task stack size (bytes)
+
+// Small fork-join job system to split one frame's work across both cores.
+// A persistent worker task is pinned to each requested core. run() hands out jobs 0..n-1
+// (e.g. one per row band or tile column) to the workers and to the calling task, and only
+// returns when every job has finished, so it is the barrier before the frame is used.
+// Each participant gets its own contiguous share of the jobs. With work stealing on, a
+// participant that finishes early takes the unstarted jobs of the others.
+// Jobs must only write their own part of the output, so the result never depends on
+// which core ran which job. With no workers run() just runs the jobs in turn.
+// Only one task may call run() at a time.
+// Usage:
+//     JobSystem jobs(1, 1); // one worker, on core 1
+//     jobs.run(8, MyMatrix::bandJob, this); // calls bandJob(this, 0..7), returns when all done
+class JobSystem
+{
+public:
+    typedef void (*JobFunction)(void *context, int job);
+
+    // create workerCount worker tasks, worker i pinned to core (firstCore + i) % portNUM_PROCESSORS
+    JobSystem(int workerCount, int firstCore, bool workStealing = true);
+    ~JobSystem();
+
+    // run function(context, job) for job 0..jobCount-1 across the workers and this task,
+    // and wait for them all to finish
+    void run(int jobCount, JobFunction function, void *context);
+
+    int getWorkerCount() const { return workerCount; }
+    // jobs run by a participant other than the one they were given to
+    uint32_t getStolenJobs() const { return stolenJobs.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker
+    {
+        JobSystem *jobSystem;
+        int index; // participant index, 0 is the task calling run()
+        TaskHandle_t taskHandle;
+    };
+
+    int workerCount;
+    bool workStealing;
+    Worker workers[JOB_SYSTEM_MAX_WORKERS];
+
+    // the current batch of jobs
+    std::atomic<uint32_t> batch; // bumped by every run(), so late workers can't claim jobs of a newer batch
+    std::atomic<JobFunction> function;
+    std::atomic<void *> context;
+    int participants = 1;
+
+    // each participant's share of the jobs: batch << 16 | end job << 8 | next job.
+    // jobs are claimed with a compare-exchange, so every job runs exactly once
+    std::atomic<uint32_t> shares[JOB_SYSTEM_MAX_WORKERS + 1];
+
+    std::atomic<int> jobsRemaining;
+    SemaphoreHandle_t batchDone = nullptr; // given when the last job of a batch finishes
+
+    std::atomic<uint32_t> stolenJobs;
+
+    // run the jobs of the given batch: the participant's own share first, then (optionally) the others'
+    void runShare(uint32_t batchId, int participant);
+    // claim the next job of a share, or -1 if it is used up or belongs to another batch
+    int claimJob(int share, uint32_t batchId);
+
+    // the worker task function: waits to be notified of a batch, then helps run it
+    void workerTask(int index);
+
+    // a static function wrapper we can use as a task function
+    static void workerTaskWrapper(void *params)
+    {
+        Worker *worker = static_cast<Worker *>(params);
+        worker->jobSystem->workerTask(worker->index);
+    }
+};
+
+#endif
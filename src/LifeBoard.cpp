@@ -0,0 +1,265 @@
+#include "LifeBoard.h"
+
+const uint32_t LifeBoard::ALL_TILES;
+
+// birth/survival masks known at compile time, so unused neighbour counts drop out of the kernel
+template <uint16_t BIRTH, uint16_t SURVIVE>
+struct FixedRuleMasks
+{
+    static uint16_t birth(const LifeRule &) { return BIRTH; }
+    static uint16_t survive(const LifeRule &) { return SURVIVE; }
+};
+
+// birth/survival masks read from the rule once per column, for any other rule
+struct RuntimeRuleMasks
+{
+    static uint16_t birth(const LifeRule &rule) { return rule.getBirthMask(); }
+    static uint16_t survive(const LifeRule &rule) { return rule.getSurviveMask(); }
+};
+
+// mask of cells whose neighbour count (bit-planes b0-b3) is one of the counts in countMask
+static inline __attribute__((always_inline)) uint32_t matchCounts(uint16_t countMask,
+                                                                   uint32_t b0, uint32_t b1,
+                                                                   uint32_t b2, uint32_t b3)
+{
+    uint32_t lowerThanEight = ~b3;
+    uint32_t matches = 0;
+    if (countMask & (1u << 0))
+        matches |= ~b0 & ~b1 & ~b2 & lowerThanEight;
+    if (countMask & (1u << 1))
+        matches |= b0 & ~b1 & ~b2 & lowerThanEight;
+    if (countMask & (1u << 2))
+        matches |= ~b0 & b1 & ~b2 & lowerThanEight;
+    if (countMask & (1u << 3))
+        matches |= b0 & b1 & ~b2 & lowerThanEight;
+    if (countMask & (1u << 4))
+        matches |= ~b0 & ~b1 & b2 & lowerThanEight;
+    if (countMask & (1u << 5))
+        matches |= b0 & ~b1 & b2 & lowerThanEight;
+    if (countMask & (1u << 6))
+        matches |= ~b0 & b1 & b2 & lowerThanEight;
+    if (countMask & (1u << 7))
+        matches |= b0 & b1 & b2 & lowerThanEight;
+    if (countMask & (1u << 8))
+        matches |= b3;
+    return matches;
+}
+
+// column row masks for each nibble of tile rows e.g. 0b0101 -> 0x00FF00FF
+static const uint32_t TILE_ROW_MASKS[16] = {
+    0x00000000, 0x000000FF, 0x0000FF00, 0x0000FFFF, 0x00FF0000, 0x00FF00FF, 0x00FFFF00, 0x00FFFFFF,
+    0xFF000000, 0xFF0000FF, 0xFF00FF00, 0xFF00FFFF, 0xFFFF0000, 0xFFFF00FF, 0xFFFFFF00, 0xFFFFFFFF};
+
+// nibble of tile rows that have any bit set in the column word
+static inline uint32_t tileRowsOf(uint32_t columnBits)
+{
+    return ((columnBits & 0x000000FF) ? 1u : 0u) | ((columnBits & 0x0000FF00) ? 2u : 0u) |
+           ((columnBits & 0x00FF0000) ? 4u : 0u) | ((columnBits & 0xFF000000) ? 8u : 0u);
+}
+
+// dilate changed tiles by one tile in every direction (tile columns are nibbles)
+uint32_t LifeBoard::calcTilesToEvaluate(bool edgeWrap) const
+{
+    uint32_t tiles = changedTiles;
+
+    // tile rows above and below, within each nibble
+    uint32_t vertical = tiles | ((tiles << 1) & 0xEEEEEEEE) | ((tiles >> 1) & 0x77777777);
+    if (edgeWrap)
+        vertical |= ((tiles >> 3) & 0x11111111) | ((tiles << 3) & 0x88888888);
+
+    // tile columns left and right, one nibble across
+    uint32_t dilated = vertical | (vertical << TILES_Y) | (vertical >> TILES_Y);
+    if (edgeWrap)
+        dilated |= (vertical >> (TILE_COUNT - TILES_Y)) | (vertical << (TILE_COUNT - TILES_Y));
+
+    return (dilated | chanceTiles) & ALL_TILES;
+}
+
+// calculate the next generation, a band at a time with the same rng
+template <class EdgePolicy>
+void LifeBoard::calcNextGeneration(const LifeBoard &current, const LifeRule &rule, FastRandom &rng)
+{
+    beginGeneration<EdgePolicy>(current);
+    for (int band = 0; band < BANDS; band++)
+    {
+        calcGenerationBand<EdgePolicy>(band, current, rule, rng);
+    }
+    endGeneration();
+}
+
+// decide which tiles the bands of the next generation need to evaluate
+template <class EdgePolicy>
+void LifeBoard::beginGeneration(const LifeBoard &current)
+{
+    evaluatedTiles = current.calcTilesToEvaluate(EdgePolicy::WRAP);
+}
+
+// calculate one band of the next generation, dispatching to a specialised kernel
+template <class EdgePolicy>
+void LifeBoard::calcGenerationBand(int band, const LifeBoard &current, const LifeRule &rule, FastRandom &rng)
+{
+    // masks are bit n = n neighbours
+    switch (rule.getKernel())
+    {
+    case LifeRule::KERNEL_CONWAY: // B3/S23
+        calcBandWith<EdgePolicy, FixedRuleMasks<0x008, 0x00C>>(band, current, rule, rng);
+        break;
+    case LifeRule::KERNEL_HIGHLIFE: // B36/S23
+        calcBandWith<EdgePolicy, FixedRuleMasks<0x048, 0x00C>>(band, current, rule, rng);
+        break;
+    case LifeRule::KERNEL_DAY_AND_NIGHT: // B3678/S34678
+        calcBandWith<EdgePolicy, FixedRuleMasks<0x1C8, 0x1D8>>(band, current, rule, rng);
+        break;
+    case LifeRule::KERNEL_SEEDS: // B2/S
+        calcBandWith<EdgePolicy, FixedRuleMasks<0x004, 0x000>>(band, current, rule, rng);
+        break;
+    default:
+        calcBandWith<EdgePolicy, RuntimeRuleMasks>(band, current, rule, rng);
+        break;
+    }
+}
+
+// record the tile activity of all the bands for the next generation
+void LifeBoard::endGeneration()
+{
+    changedTiles = 0;
+    chanceTiles = 0;
+    for (int band = 0; band < BANDS; band++)
+    {
+        changedTiles |= getBandChangedTiles(band);
+        chanceTiles |= tileRowsOf(bandChances[band]) << (band * TILES_Y);
+    }
+}
+
+// tiles of the band that changed, once calcGenerationBand() has run for it
+uint32_t LifeBoard::getBandChangedTiles(int band) const
+{
+    return tileRowsOf(bandChanges[band]) << (band * TILES_Y);
+}
+
+// vertical sums of one column: 'pair' = neighbours above + below (used when it's the centre column),
+// 'triple' = above + cell + below (used when it's the left or right column). 2 bit-planes each.
+template <class EdgePolicy>
+static inline void calcColumnSums(uint32_t column, uint32_t &pair0, uint32_t &pair1,
+                                  uint32_t &triple0, uint32_t &triple1)
+{
+    // shift neighbours above (y-1) and below (y+1) into bit y. when wrapping, the rows
+    // beyond the top and bottom edges are the opposite rows, rotated in
+    uint32_t above = column << 1;
+    uint32_t below = column >> 1;
+    if (EdgePolicy::WRAP)
+    {
+        above |= column >> (LifeBoard::HEIGHT - 1);
+        below |= column << (LifeBoard::HEIGHT - 1);
+    }
+
+    pair0 = above ^ below;
+    pair1 = above & below;
+    // full adder of above + column + below
+    triple0 = pair0 ^ column;
+    triple1 = pair1 | (column & pair0);
+}
+
+// calculate one band (tile column) of the next generation of 'current' into this board,
+// a whole column at a time.
+// neighbour counts are held as 4 bit-planes (count = b0 + 2*b1 + 4*b2 + 8*b3) per column.
+template <class EdgePolicy, class RuleMasks>
+void LifeBoard::calcBandWith(int band, const LifeBoard &current, const LifeRule &rule, FastRandom &rng)
+{
+    int xStart = band * TILE_SIZE;
+    bandChanges[band] = 0;
+    bandChances[band] = 0;
+
+    // settled tiles (unchanged neighbourhood, no chance-based cells) stay as they are
+    uint32_t rowsToEvaluate = TILE_ROW_MASKS[(evaluatedTiles >> (band * TILES_Y)) & 0xF];
+    if (rowsToEvaluate == 0)
+    {
+        for (int x = xStart; x < xStart + TILE_SIZE; x++)
+        {
+            columns[x] = current.columns[x];
+        }
+        return;
+    }
+
+    // column sums of the band. the triples have a ghost column either side, the band's
+    // neighbouring columns (the opposite edge of the board when wrapping, dead otherwise),
+    // so column i's left and right neighbours are always triple[i] and triple[i + 2]
+    uint32_t pair0[TILE_SIZE], pair1[TILE_SIZE];
+    uint32_t triple0[TILE_SIZE + 2], triple1[TILE_SIZE + 2];
+    uint32_t unusedPair0, unusedPair1;
+
+    for (int i = 0; i < TILE_SIZE; i++)
+    {
+        calcColumnSums<EdgePolicy>(current.columns[xStart + i], pair0[i], pair1[i], triple0[i + 1], triple1[i + 1]);
+    }
+    int leftX = xStart - 1;
+    int rightX = xStart + TILE_SIZE;
+    if (EdgePolicy::WRAP || leftX >= 0)
+        calcColumnSums<EdgePolicy>(current.columns[(leftX + WIDTH) % WIDTH], unusedPair0, unusedPair1, triple0[0], triple1[0]);
+    else
+        triple0[0] = triple1[0] = 0;
+    if (EdgePolicy::WRAP || rightX < WIDTH)
+        calcColumnSums<EdgePolicy>(current.columns[rightX % WIDTH], unusedPair0, unusedPair1,
+                                   triple0[TILE_SIZE + 1], triple1[TILE_SIZE + 1]);
+    else
+        triple0[TILE_SIZE + 1] = triple1[TILE_SIZE + 1] = 0;
+
+    int chanceGroupCount = rule.getChanceGroupCount();
+
+    for (int i = 0; i < TILE_SIZE; i++)
+    {
+        int x = xStart + i;
+        uint32_t alive = current.columns[x];
+
+        // left and right column sums, from the ghost columns at the band edges
+        uint32_t left0 = triple0[i];
+        uint32_t left1 = triple1[i];
+        uint32_t right0 = triple0[i + 2];
+        uint32_t right1 = triple1[i + 2];
+
+        // add left (0-3) + right (0-3) + centre pair (0-2) into a 4-bit count (0-8)
+        // bit 0: full adder of the low bits
+        uint32_t lowXor = left0 ^ right0;
+        uint32_t b0 = lowXor ^ pair0[i];
+        uint32_t carry = (left0 & right0) | (pair0[i] & lowXor);
+        // bit 1: full adder of the high bits, then half adder with the carry from bit 0
+        uint32_t highXor = left1 ^ right1;
+        uint32_t highSum = highXor ^ pair1[i];
+        uint32_t highCarry = (left1 & right1) | (pair1[i] & highXor);
+        uint32_t b1 = highSum ^ carry;
+        uint32_t sumCarry = highSum & carry;
+        // bits 2 and 3: add the two carries out of bit 1
+        uint32_t b2 = highCarry ^ sumCarry;
+        uint32_t b3 = highCarry & sumCarry;
+
+        uint32_t born = ~alive & matchCounts(RuleMasks::birth(rule), b0, b1, b2, b3);
+        uint32_t survived = alive & matchCounts(RuleMasks::survive(rule), b0, b1, b2, b3);
+
+        // chance-based outcomes: one random mask per group of counts sharing a chance, drawn
+        // only for the cells in the group. e.g. stochastic death is alive & ~deathMask
+        for (int group = 0; group < chanceGroupCount; group++)
+        {
+            const LifeRule::ChanceGroup &chanceGroup = rule.getChanceGroup(group);
+            uint32_t lanes = (~alive & matchCounts(chanceGroup.countMask[0], b0, b1, b2, b3)) |
+                             (alive & matchCounts(chanceGroup.countMask[1], b0, b1, b2, b3));
+            lanes &= rowsToEvaluate;
+            if (lanes)
+            {
+                born |= rng.bernoulliMask(chanceGroup.probability, lanes);
+                bandChances[band] |= lanes;
+            }
+        }
+
+        uint32_t newColumn = ((born | survived) & rowsToEvaluate) | (alive & ~rowsToEvaluate);
+        bandChanges[band] |= newColumn ^ alive;
+        columns[x] = newColumn;
+    }
+}
+
+// the edge policies used by LifeEngine
+template void LifeBoard::calcNextGeneration<WrappedEdges>(const LifeBoard &, const LifeRule &, FastRandom &);
+template void LifeBoard::calcNextGeneration<DeadEdges>(const LifeBoard &, const LifeRule &, FastRandom &);
+template void LifeBoard::beginGeneration<WrappedEdges>(const LifeBoard &);
+template void LifeBoard::beginGeneration<DeadEdges>(const LifeBoard &);
+template void LifeBoard::calcGenerationBand<WrappedEdges>(int, const LifeBoard &, const LifeRule &, FastRandom &);
+template void LifeBoard::calcGenerationBand<DeadEdges>(int, const LifeBoard &, const LifeRule &, FastRandom &);
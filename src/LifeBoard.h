@@ -0,0 +1,132 @@
+#ifndef LIFEBOARD_H
+#define LIFEBOARD_H
+
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include "Matrix.h"
+#include "LifeRule.h"
+#include "FastRandom.h"
+
+// Compile-time edge handling for LifeBoard generations.
+// cells beyond an edge are the cells on the opposite edge (the board is a torus)
+struct WrappedEdges
+{
+    static const bool WRAP = true;
+};
+// cells beyond the edges are always dead
+struct DeadEdges
+{
+    static const bool WRAP = false;
+};
+
+// Bit-packed Game of Life board.
+// Each column of the matrix is stored as one 32-bit word (bit y = cell (x,y)), so the
+// neighbour counts of a whole column are calculated at once with bitwise full-adder
+// logic (SWAR) instead of 8 branchy reads per cell.
+// The board is also split into 8x8 tiles. Each generation records which tiles changed and
+// which had chance-based cells; the next generation only evaluates tiles whose
+// neighbourhood changed (or that have chance-based cells), as settled tiles can't change.
+// Tile bitmaps use one bit per tile, see tileBit().
+// A generation can also be calculated in bands, one per tile column, which only write their
+// own columns, so the bands can run on different cores (see JobSystem).
+// Usage:
+//     LifeBoard current, next;
+//     current.setCell(x, y, true);
+//     next.calcNextGeneration<WrappedEdges>(current, rule, rng);
+//     // or in bands, each with its own rng so the result doesn't depend on the order they run in
+//     next.beginGeneration<WrappedEdges>(current);
+//     next.calcGenerationBand<WrappedEdges>(band, current, rule, bandRngs[band]); // band 0..BANDS-1
+//     next.endGeneration();
+class LifeBoard
+{
+public:
+    static const int WIDTH = Matrix::MATRIX_ARRAY_WIDTH;
+    static const int HEIGHT = Matrix::MATRIX_ARRAY_HEIGHT;
+    static_assert(HEIGHT == 32, "LifeBoard packs one column of cells into a 32-bit word");
+
+    static const int TILE_SIZE = 8;                 // tiles are 8x8 cells
+    static const int TILES_X = WIDTH / TILE_SIZE;   // 8 tile columns
+    static const int TILES_Y = HEIGHT / TILE_SIZE;  // 4 tile rows, one per byte of a column
+    static const int TILE_COUNT = TILES_X * TILES_Y;
+    static_assert(TILES_Y == 4 && TILE_COUNT <= 32, "LifeBoard tile bitmaps must fit a 32-bit word");
+    static const uint32_t ALL_TILES = (TILE_COUNT == 32) ? 0xFFFFFFFF : ((1u << TILE_COUNT) - 1);
+    static const int BANDS = TILES_X; // generation bands, one per tile column
+
+    // bit for tile (tileX, tileY) in the tile bitmaps. each tile column is a nibble
+    static uint32_t tileBit(int tileX, int tileY) { return 1u << (tileX * TILES_Y + tileY); }
+
+    LifeBoard() { clear(); }
+
+    // set all cells dead
+    void clear()
+    {
+        columns.fill(0);
+        markAllChanged();
+    }
+
+    // force every tile to be evaluated next generation e.g. after a rule change
+    void markAllChanged() { changedTiles = ALL_TILES; }
+
+    bool getCell(int x, int y) const { return (columns[x] >> y) & 1u; }
+    void setCell(int x, int y, bool alive)
+    {
+        if (alive)
+            columns[x] |= (1u << y);
+        else
+            columns[x] &= ~(1u << y);
+        changedTiles |= tileBit(x / TILE_SIZE, y / TILE_SIZE);
+    }
+
+    // whole column of cells, bit y = cell (x,y)
+    uint32_t getColumn(int x) const { return columns[x]; }
+    void setColumn(int x, uint32_t column)
+    {
+        columns[x] = column;
+        changedTiles |= 0xFu << ((x / TILE_SIZE) * TILES_Y);
+    }
+
+    // tiles that changed in the last generation
+    uint32_t getChangedTiles() const { return changedTiles; }
+    // tiles that were evaluated in the last generation
+    uint32_t getEvaluatedTiles() const { return evaluatedTiles; }
+    int getEvaluatedTileCount() const { return __builtin_popcount(evaluatedTiles); }
+
+    // calculate the next generation of 'current' into this board using the given rule.
+    // Common rules run a compile-time specialised kernel, chosen once per generation.
+    // Cells with a chance-based outcome are decided with random bit masks from rng.
+    // EdgePolicy is WrappedEdges or DeadEdges.
+    template <class EdgePolicy>
+    void calcNextGeneration(const LifeBoard &current, const LifeRule &rule, FastRandom &rng);
+
+    // the same generation in steps: beginGeneration() once, then calcGenerationBand() for
+    // every band (in any order, or at the same time), then endGeneration() once.
+    template <class EdgePolicy>
+    void beginGeneration(const LifeBoard &current);
+    template <class EdgePolicy>
+    void calcGenerationBand(int band, const LifeBoard &current, const LifeRule &rule, FastRandom &rng);
+    void endGeneration();
+    // tiles of a band that changed, as soon as its calcGenerationBand() has finished
+    uint32_t getBandChangedTiles(int band) const;
+
+private:
+    std::array<uint32_t, WIDTH> columns;
+
+    uint32_t changedTiles = ALL_TILES; // tiles with a cell that changed last generation
+    uint32_t chanceTiles = 0;          // tiles with a chance-based cell last generation
+    uint32_t evaluatedTiles = ALL_TILES;
+
+    // per band: rows of cells that changed / had a chance-based outcome, all the band's columns or'd
+    uint32_t bandChanges[BANDS] = {0};
+    uint32_t bandChances[BANDS] = {0};
+
+    // tiles to evaluate next generation: changed tiles plus their neighbours, and chance tiles
+    uint32_t calcTilesToEvaluate(bool edgeWrap) const;
+
+    // the generation loop for one band, specialised on the edges and on where the birth/survival masks come from
+    template <class EdgePolicy, class RuleMasks>
+    void calcBandWith(int band, const LifeBoard &current, const LifeRule &rule, FastRandom &rng);
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "LifeColors.h"
+
+// update the colors from the current HSV values once per frame
+void HueLifeColors::calcStateColors(float relativeBrightness, CRGB colors[CELL_STATE_COUNT])
+{
+    uint8_t adjustedAliveVal = relativeBrightness * hsvVal;
+    uint8_t adjustedJustBornVal = relativeBrightness * hsvValJustBorn;
+    uint8_t adjustedJustDiedVal = relativeBrightness * hsvValJustDied;
+    uint8_t adjustedDeadVal = relativeBrightness * hsvValDead;
+
+    colors[CELL_ALIVE] = hsvToCRGB(hsvHue, adjustedAliveVal);
+    colors[CELL_JUST_DIED] = hsvToCRGB((hsvHue + JUST_DIED_HUE_OFFSET), adjustedJustDiedVal);
+    colors[CELL_JUST_BORN] = hsvToCRGB((hsvHue + JUST_BORN_HUE_OFFSET), adjustedJustBornVal);
+    colors[CELL_DEAD] = hsvToCRGB((hsvHue + DEAD_HUE_OFFSET), adjustedDeadVal);
+
+    // // every 10 frames log the color values for debugging
+    // static int frameCount = 0;
+    // frameCount++;
+    // if (frameCount >= 10)
+    // {
+    //     frameCount = 0;
+
+    //     Logger::printf("Original HSV: Hue: %d, Sat: %d, Val: %d\n", hsvHue, hsvSat, hsvVal);
+    //     Logger::printf("Relative Brightness: %.2f\n", relativeBrightness);
+    //     Logger::printf("Adjusted Vals - Alive: %d, JustBorn: %d, JustDied: %d, Dead: %d\n",
+    //                    adjustedAliveVal, adjustedJustBornVal, adjustedJustDiedVal, adjustedDeadVal);
+    // }
+}
+
+CRGB HueLifeColors::hsvToCRGB(uint16_t hue, uint8_t val)
+{
+    uint8_t r, g, b;
+    Matrix::hsvToRGB(hue, hsvSat, val, r, g, b);
+    return CRGB(r, g, b);
+}
+
+// update the colors from the current palette and indices once per frame
+void PaletteLifeColors::calcStateColors(float relativeBrightness, CRGB colors[CELL_STATE_COUNT])
+{
+    uint8_t adjustedAliveBrightness = (uint8_t) (255 * relativeBrightness * aliveBrightness);
+    uint8_t adjustedJustBornBrightness = (uint8_t) (255 * relativeBrightness * justBornBrightness);
+    uint8_t adjustedJustDiedBrightness = (uint8_t) (255 * relativeBrightness * justDiedBrightness);
+    uint8_t adjustedDeadBrightness = (uint8_t) (255 * relativeBrightness * deadBrightness);
+
+    // step through any palette morph, once per frame. 255 = all the current palette
+    uint8_t morphWeight = 255;
+    if (morphFrame < morphFrames)
+    {
+        morphFrame++;
+        morphWeight = (morphFrame * 255) / morphFrames;
+    }
+
+    CRGB &aliveRGB = colors[CELL_ALIVE];
+    CRGB &justDiedRGB = colors[CELL_JUST_DIED];
+    CRGB &justBornRGB = colors[CELL_JUST_BORN];
+    CRGB &deadRGB = colors[CELL_DEAD];
+    aliveRGB = ColorFromMorphingPalette(alivePalInd, adjustedAliveBrightness, morphWeight);
+    justDiedRGB = ColorFromMorphingPalette(justDiedPalIndOffset + alivePalInd, adjustedJustDiedBrightness, morphWeight);
+    justBornRGB = ColorFromMorphingPalette(justBornPalIndOffset + alivePalInd, adjustedJustBornBrightness, morphWeight);
+    deadRGB = ColorFromMorphingPalette(deadPalIndOffset + alivePalInd, adjustedDeadBrightness, morphWeight);
+
+    // every 50 frames log the color values for debugging
+    static int frameCount = 0;
+    frameCount++;
+    if (frameCount >= 50)
+    {
+        frameCount = 0;
+        Logger::printf("Current palette Index: %d\n", currentPaletteIndex.load());
+        Logger::printf("Alive Index in palette: %d\n", alivePalInd);
+        Logger::printf("Relative Brightness: %.2f\n", relativeBrightness);
+        Logger::printf("Adjusted Brightnesses - Alive: %d, JustBorn: %d, JustDied: %d, Dead: %d\n",
+                       adjustedAliveBrightness, adjustedJustBornBrightness, adjustedJustDiedBrightness, adjustedDeadBrightness);
+        Logger::printf("RGB colors: Alive R:%d G:%d B:%d | JustBorn R:%d G:%d B:%d | JustDied R:%d G:%d B:%d | Dead R:%d G:%d B:%d\n",
+                       aliveRGB[0], aliveRGB[1], aliveRGB[2],
+                       justBornRGB[0], justBornRGB[1], justBornRGB[2],
+                       justDiedRGB[0], justDiedRGB[1], justDiedRGB[2],
+                       deadRGB[0], deadRGB[1], deadRGB[2]);
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef LIFECOLORS_H
+#define LIFECOLORS_H
+
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <atomic>
+#include "Matrix.h"
+#include "Logger.h"
+#include "FastRandom.h"
+
+#define HUE_CYCLING_SHIFT 64
+#define JUST_BORN_HUE_OFFSET -8000
+#define JUST_DIED_HUE_OFFSET 8000
+#define DEAD_HUE_OFFSET 30000
+#define LIFE_PALETTE_TRANSITION_FRAMES 30 // frames to morph between palettes
+
+// cell states that get their own colour, index = (alive now << 1) | alive before
+enum LifeCellState
+{
+    CELL_DEAD = 0,
+    CELL_JUST_DIED = 1,
+    CELL_JUST_BORN = 2,
+    CELL_ALIVE = 3,
+    CELL_STATE_COUNT = 4
+};
+
+// Colour policies for LifeEngine. Each works out the colour of every cell state once per frame:
+//     static const char *name();                   // name for logging
+//     bool setHue(uint16_t hue);                   // returns false if hue isn't used
+//     void nextPalette();                          // may do nothing
+//     void setTransitionFrames(int frames);        // frames a palette change takes, may do nothing
+//     void randomise(FastRandom &rng);             // on initialise, may do nothing
+//     void advance();                              // next step when cycling
+//     void calcStateColors(float relativeBrightness, CRGB colors[CELL_STATE_COUNT]);
+
+// HSV colours following a hue, which cycles by HUE_CYCLING_SHIFT a frame
+class HueLifeColors
+{
+public:
+    static const char *name() { return "GameLifeMatrix"; }
+
+    bool setHue(uint16_t hue)
+    {
+        this->hsvHue = hue;
+        return true;
+    }
+    void nextPalette() {}
+    void setTransitionFrames(int frames) {}
+    void randomise(FastRandom &rng) {}
+    void advance() { hsvHue += HUE_CYCLING_SHIFT; }
+
+    void calcStateColors(float relativeBrightness, CRGB colors[CELL_STATE_COUNT]);
+
+private:
+    // HSV values for color generation
+    uint16_t hsvHue = 0;
+    uint8_t hsvSat = 255;
+    uint8_t hsvVal = 225;
+    uint8_t hsvValJustDied = (hsvVal / 3) * 2;
+    uint8_t hsvValJustBorn = 255;
+    uint8_t hsvValDead = 80;
+
+    CRGB hsvToCRGB(uint16_t hue, uint8_t val);
+};
+
+// colours from FastLED palettes, moving along the palette one index a frame.
+// a new palette is morphed to over a number of frames: each state colour is blended
+// from the old palette's colour to the new one's, so it costs four blends a frame
+class PaletteLifeColors
+{
+public:
+    PaletteLifeColors()
+    {
+        currentPaletteIndex.store(0);
+        transitionFrames.store(LIFE_PALETTE_TRANSITION_FRAMES);
+    }
+
+    static const char *name() { return "GameLifeMatrix2"; }
+
+    bool setHue(uint16_t hue) { return false; } // colours come from the palettes only
+    // move to next pallette in list
+    void nextPalette()
+    {
+        int index = currentPaletteIndex.load();
+        // morph from the palette we're leaving
+        previousPaletteIndex = index;
+        morphFrame = 0;
+        morphFrames = transitionFrames.load();
+        index = (index + 1) % (sizeof(palettes) / sizeof(palettes[0]));
+        currentPaletteIndex.store(index);
+        Logger::printf("Switched to palette index %d\n", index);
+    }
+    void setTransitionFrames(int frames) { transitionFrames.store(frames); }
+    void randomise(FastRandom &rng) { alivePalInd = rng.nextBelow(255); } // random palette index
+    void advance() { alivePalInd += 1; }
+
+    void calcStateColors(float relativeBrightness, CRGB colors[CELL_STATE_COUNT]);
+
+private:
+    // color palettes
+    std::atomic<int> currentPaletteIndex;
+    std::atomic<int> transitionFrames;
+    // palette being morphed from, and how far through the morph we are
+    int previousPaletteIndex = 0;
+    int morphFrame = 0;
+    int morphFrames = 0;
+    CRGBPalette16 palettes[8] = {HeatColors_p, LavaColors_p, ForestColors_p, CloudColors_p, OceanColors_p,
+                                 PartyColors_p, RainbowColors_p, RainbowStripeColors_p};
+    CRGB ColorFromCurrentPalette(uint8_t index = 0, uint8_t brightness = 255, TBlendType blendType = LINEARBLEND)
+    {
+        return ColorFromPalette(palettes[currentPaletteIndex.load()], index, brightness, blendType);
+    }
+    // colour from the current palette, blended from the previous one while morphing
+    CRGB ColorFromMorphingPalette(uint8_t index, uint8_t brightness, uint8_t morphWeight)
+    {
+        CRGB color = ColorFromCurrentPalette(index, brightness);
+        if (morphWeight == 255)
+            return color;
+        return blend(ColorFromPalette(palettes[previousPaletteIndex], index, brightness), color, morphWeight);
+    }
+
+    // relative brightnesses of each state (0-1.0f, multiplied by palette color brightness)
+    float aliveBrightness = 0.9f;
+    float justBornBrightness = 1.0f;
+    float justDiedBrightness = 0.7f;
+    float deadBrightness = 0.3f;
+
+    // Current frame palette indices
+    int alivePalInd = 0; // changes each frame
+    int justBornPalIndOffset = 50;
+    int justDiedPalIndOffset = -50;
+    int deadPalIndOffset = 128;
+};
+
+#endif
@@ -0,0 +1,289 @@
+#include "LifeEngine.h"
+
+template <class ColorPolicy, class EdgePolicy>
+LifeEngine<ColorPolicy, EdgePolicy>::LifeEngine(int initDensityPercentage, bool highPrecisionTrails)
+{
+    this->backgroundModeRelativeBrightness = BACKGROUND_MODE_RELATIVE_BRIGHTNESS_GAME;
+    this->foregroundModeRelativeBrightness = FOREGROUND_MODE_RELATIVE_BRIGHTNESS_GAME;
+
+    this->initDensityPercentage = initDensityPercentage;
+
+    // optional high-precision trails, blended at 8.8 fixed point per channel
+    if (highPrecisionTrails)
+    {
+        accumulator = new ColorAccumulator();
+        Logger::printf("%s trail accumulation buffer: %u bytes\n", ColorPolicy::name(),
+                       (unsigned int)accumulator->getMemoryBytes());
+    }
+
+    // live cells with less than two or more than three neighbours have a small chance of surviving
+    rule.setRuleString(DEFAULT_LIFE_RULE);
+    rule.setSurvivalChance(0, 1, (100 - UNDERPOPULATION_DEATH_CHANCE) * 10); // scale to 0-1000
+    rule.setSurvivalChance(4, 8, (100 - OVERPOPULATION_DEATH_CHANCE) * 10);  // scale to 0-1000
+    requestedRule = rule;
+    ruleChangeRequested.store(false);
+    tilesEvaluated.store(0);
+    tilesBlended.store(0);
+    ruleMutex = xSemaphoreCreateMutex();
+    if (ruleMutex == NULL)
+    {
+        Logger::println("ERROR: Failed to create ruleMutex");
+    }
+
+    // set dafaults
+    this->backgroundMode.store(true);
+    this->currentRelativeBrightness.store(this->backgroundModeRelativeBrightness);
+    this->cycling.store(true);
+
+    initialise();
+}
+
+// Initialize the current state buffer with random values
+template <class ColorPolicy, class EdgePolicy>
+void LifeEngine<ColorPolicy, EdgePolicy>::initialise()
+{
+    // Initialize colors
+    updateStateColors();
+    uint16_t aliveCol = stateColors[CELL_ALIVE];
+    uint16_t deadCol = stateColors[CELL_DEAD];
+    colors.randomise(rng);
+
+    // all colors are rewritten, so nothing has settled
+    settledColorTiles = 0;
+
+    // each cell has initDensityPercentage chance of being alive, a column at a time
+    uint16_t initDensity = FastRandom::probability(initDensityPercentage, 100);
+    for (int x = 0; x < MATRIX_ARRAY_WIDTH; x++)
+    {
+        boardPrimary.setColumn(x, rng.bernoulliMask(initDensity));
+    }
+
+    // colors based on alive/dead states
+    for (int y = 0; y < MATRIX_ARRAY_HEIGHT; y++)
+    {
+        for (int x = 0; x < MATRIX_ARRAY_WIDTH; x++)
+        {
+            bool alive = boardPrimary.getCell(x, y);
+            bufferPrimary->at(x, y) = alive ? aliveCol : deadCol;
+            if (accumulator != nullptr)
+                accumulator->setCell(x, y, alive ? stateCells[CELL_ALIVE] : stateCells[CELL_DEAD]);
+        }
+    }
+    bufferSecondary->fill(deadCol);
+}
+
+// Calculate new states based on current states
+template <class ColorPolicy, class EdgePolicy>
+void LifeEngine<ColorPolicy, EdgePolicy>::calcNewStates()
+{
+    // apply any requested rule change. the flag is only set after requestedRule is written,
+    // and both are cleared and copied together under the mutex
+    if (ruleChangeRequested.load() && xSemaphoreTake(ruleMutex, portMAX_DELAY) == pdTRUE)
+    {
+        rule = requestedRule;
+        ruleChangeRequested.store(false);
+        xSemaphoreGive(ruleMutex);
+        boardPrimary.markAllChanged(); // every tile needs evaluating under the new rule
+        Logger::printf("Switched to rule %s\n", rule.getRuleString());
+    }
+
+    // decide which tiles need evaluating this generation
+    boardSecondary.template beginGeneration<EdgePolicy>(boardPrimary);
+
+    // settled tiles can only skip blending if the base colours are the same as last frame
+    baseColorsChanged = memcmp(stateColors, lastStateColors, sizeof(stateColors)) != 0 ||
+                        memcmp(stateCells, lastStateCells, sizeof(stateCells)) != 0;
+    memcpy(lastStateColors, stateColors, sizeof(stateColors));
+    memcpy(lastStateCells, stateCells, sizeof(stateCells));
+
+    // each band draws its chance-based outcomes from its own random sequence, seeded from the
+    // matrix's, so the generation is the same whichever core runs which band
+    for (int band = 0; band < LifeBoard::BANDS; band++)
+    {
+        bandRngs[band].seed(rng.next());
+    }
+
+    // new states and colors a band (tile column) at a time, spread across the job system if set
+    runJobs(LifeBoard::BANDS, LifeEngine::bandJob, this);
+
+    // gather the bands' results
+    boardSecondary.endGeneration();
+    uint32_t newSettledColorTiles = 0;
+    int blended = 0;
+    for (int band = 0; band < LifeBoard::BANDS; band++)
+    {
+        newSettledColorTiles |= bandSettledColorTiles[band];
+        blended += bandTilesBlended[band];
+    }
+    settledColorTiles = newSettledColorTiles;
+    tilesBlended.store(blended, std::memory_order_relaxed);
+    tilesEvaluated.store(boardSecondary.getEvaluatedTileCount(), std::memory_order_relaxed);
+
+    // now swap buffers. this puts the new cell states into the primary buffer
+    // and stores the old states in the secondary buffer. Note that the
+    // old states are overwritten on the next calcNewStates() call.
+    std::swap(boardPrimary, boardSecondary);
+    std::swap(bufferPrimary, bufferSecondary);
+
+    // colour base-values for next frame if needed
+    if (cycling.load())
+        colors.advance();
+
+    // Update colors for next frame
+    updateStateColors();
+}
+
+// calculate one band of the next generation, then blend the colors of its tiles.
+// only touches the band's own columns and results, so bands can run at the same time
+template <class ColorPolicy, class EdgePolicy>
+void LifeEngine<ColorPolicy, EdgePolicy>::calcBand(int band)
+{
+    // Determine new alive/dead states for the band based on Game of Life rules
+    boardSecondary.template calcGenerationBand<EdgePolicy>(band, boardPrimary, rule, bandRngs[band]);
+
+    uint32_t changedTiles = boardSecondary.getBandChangedTiles(band);
+    uint32_t tilesToBlend = baseColorsChanged ? LifeBoard::ALL_TILES : ~(settledColorTiles & ~changedTiles);
+
+    // blend colors a tile at a time. tiles whose colors have converged are just copied
+    uint32_t newSettledColorTiles = 0;
+    int blended = 0;
+    for (int tileY = 0; tileY < LifeBoard::TILES_Y; tileY++)
+    {
+        uint32_t tileBit = LifeBoard::tileBit(band, tileY);
+        bool colorsSettled;
+        if (tilesToBlend & tileBit)
+        {
+            colorsSettled = calcTileColors(band, tileY) && !(changedTiles & tileBit);
+            blended++;
+        }
+        else
+        {
+            copyTileColors(band, tileY);
+            colorsSettled = true;
+        }
+        if (colorsSettled)
+            newSettledColorTiles |= tileBit;
+    }
+    bandSettledColorTiles[band] = newSettledColorTiles;
+    bandTilesBlended[band] = blended;
+}
+
+// request new birth/survival rules, keeping the chance-based survival settings.
+// called from other tasks while the producer calculates, so only touches requestedRule
+template <class ColorPolicy, class EdgePolicy>
+bool LifeEngine<ColorPolicy, EdgePolicy>::setRule(const char *ruleString)
+{
+    if (xSemaphoreTake(ruleMutex, portMAX_DELAY) != pdTRUE)
+        return false;
+    // an invalid string leaves the requested rule as it was
+    bool valid = requestedRule.setRuleString(ruleString);
+    if (valid)
+    {
+        ruleChangeRequested.store(true);
+    }
+    xSemaphoreGive(ruleMutex);
+
+    if (!valid)
+        Logger::printf("Invalid rule %s\n", ruleString);
+    return valid;
+}
+
+// tiles of the last frame whose states were evaluated and whose colors were blended,
+// out of every tile. the rest were skipped as nothing in or around them changed
+template <class ColorPolicy, class EdgePolicy>
+void LifeEngine<ColorPolicy, EdgePolicy>::logFrameStats()
+{
+    Logger::printf("Tiles - Evaluated: %d, Blended: %d, of %d\n",
+                   getTilesEvaluated(), getTilesBlended(), LifeBoard::TILE_COUNT);
+}
+
+// update the 565 and full-precision state colors from the colour policy once per frame
+template <class ColorPolicy, class EdgePolicy>
+void LifeEngine<ColorPolicy, EdgePolicy>::updateStateColors()
+{
+    CRGB frameColors[CELL_STATE_COUNT];
+    colors.calcStateColors(currentRelativeBrightness.load(), frameColors);
+    for (int state = 0; state < CELL_STATE_COUNT; state++)
+    {
+        const CRGB &color = frameColors[state];
+        stateColors[state] = rgbTo565(color.r, color.g, color.b);
+        stateCells[state] = ColorAccumulator::fromRGB(color.r, color.g, color.b);
+    }
+}
+
+// blend the new colors of one tile into the secondary buffer.
+// returns true if no color changed i.e. the tile has converged
+template <class ColorPolicy, class EdgePolicy>
+bool LifeEngine<ColorPolicy, EdgePolicy>::calcTileColors(int tileX, int tileY)
+{
+    bool unchanged = true;
+    int xStart = tileX * LifeBoard::TILE_SIZE;
+    int yStart = tileY * LifeBoard::TILE_SIZE;
+
+    // new and previous states of the tile's columns
+    uint32_t newColumns[LifeBoard::TILE_SIZE];
+    uint32_t prevColumns[LifeBoard::TILE_SIZE];
+    for (int i = 0; i < LifeBoard::TILE_SIZE; i++)
+    {
+        newColumns[i] = boardSecondary.getColumn(xStart + i);
+        prevColumns[i] = boardPrimary.getColumn(xStart + i);
+    }
+
+    // blend a row of the tile at a time
+    alignas(4) uint16_t baseColors[LifeBoard::TILE_SIZE];
+    for (int y = yStart; y < yStart + LifeBoard::TILE_SIZE; y++)
+    {
+        if (accumulator != nullptr)
+        {
+            // blend at full precision, then take the 565 colors from the accumulated ones
+            ColorAccumulator::Cell baseCells[LifeBoard::TILE_SIZE];
+            for (int i = 0; i < LifeBoard::TILE_SIZE; i++)
+            {
+                baseCells[i] = stateCells[(((newColumns[i] >> y) & 1u) << 1) | ((prevColumns[i] >> y) & 1u)];
+            }
+            unchanged &= accumulator->blendSpan(xStart, y, baseCells, LifeBoard::TILE_SIZE, prevCellInfluence,
+                                                bufferSecondary->span(xStart, y));
+            continue;
+        }
+
+        // base color based on new state and previous state
+        for (int i = 0; i < LifeBoard::TILE_SIZE; i++)
+        {
+            baseColors[i] = stateColors[(((newColumns[i] >> y) & 1u) << 1) | ((prevColumns[i] >> y) & 1u)];
+        }
+
+        // now blend with previous cell colors based on influence factor, two pixels at a time
+        uint16_t *newColors = bufferSecondary->span(xStart, y);
+        const uint16_t *prevColors = bufferPrimary->span(xStart, y);
+        ColorMath::blendRow565(newColors, baseColors, prevColors, LifeBoard::TILE_SIZE, prevCellInfluence);
+        unchanged &= (memcmp(newColors, prevColors, LifeBoard::TILE_SIZE * sizeof(uint16_t)) == 0);
+    }
+    return unchanged;
+}
+
+// copy the colors of one tile to the secondary buffer unchanged
+template <class ColorPolicy, class EdgePolicy>
+void LifeEngine<ColorPolicy, EdgePolicy>::copyTileColors(int tileX, int tileY)
+{
+    int xStart = tileX * LifeBoard::TILE_SIZE;
+    for (int y = tileY * LifeBoard::TILE_SIZE; y < (tileY + 1) * LifeBoard::TILE_SIZE; y++)
+    {
+        memcpy(bufferSecondary->span(xStart, y), bufferPrimary->span(xStart, y), LifeBoard::TILE_SIZE * sizeof(uint16_t));
+    }
+}
+
+template <class ColorPolicy, class EdgePolicy>
+LifeEngine<ColorPolicy, EdgePolicy>::~LifeEngine()
+{
+    delete accumulator;
+    if (ruleMutex != NULL)
+    {
+        vSemaphoreDelete(ruleMutex);
+    }
+}
+
+// the engines in use, see GameLifeMatrix.h and GameLifeMatrix2.h, and their dead-edge versions
+template class LifeEngine<HueLifeColors, WrappedEdges>;
+template class LifeEngine<HueLifeColors, DeadEdges>;
+template class LifeEngine<PaletteLifeColors, WrappedEdges>;
+template class LifeEngine<PaletteLifeColors, DeadEdges>;
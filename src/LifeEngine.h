@@ -0,0 +1,134 @@
+#ifndef LIFEENGINE_H
+#define LIFEENGINE_H
+
+#pragma once
+
+#include <FastLED.h>
+#include <atomic>
+#include "Matrix.h"
+#include "LifeBoard.h"
+#include "LifeColors.h"
+#include "ColorMath.h"
+#include "ColorAccumulator.h"
+
+#define BACKGROUND_MODE_RELATIVE_BRIGHTNESS_GAME 0.621f
+#define FOREGROUND_MODE_RELATIVE_BRIGHTNESS_GAME 1.0f
+#define UNDERPOPULATION_DEATH_CHANCE 99
+#define OVERPOPULATION_DEATH_CHANCE 95
+#define DEFAULT_LIFE_RULE LIFE_RULE_HIGHLIFE
+// 1. Any live cell with less than two live neighbours has UNDERPOPULATION_DEATH_CHANCE%
+// chance of dying due to underpopulation.
+// 2. Any live cell with two or three live neighbours lives on to the next generation.
+// 3. Any live cell with more than three live neighbours has OVERPOPULATION_DEATH_CHANCE%
+// chance of dying due to overpopulation.
+// 4. Any dead cell with exactly three or 6 live neighbours becomes a live cell by
+// reproduction.
+// 5. Otherwise the cell remains dead.
+// Rules 2, 4 & 5 come from the B/S rulestring (default B36/S23) and can be changed with setRule().
+
+// Game of Life matrix with trails.
+// The colour scheme (ColorPolicy, see LifeColors.h) and the edge handling (EdgePolicy,
+// WrappedEdges or DeadEdges) are compile-time policies, so neither costs a runtime
+// branch in the generation or blend loops. Instantiated in LifeEngine.cpp.
+// Usage:
+//     typedef LifeEngine<HueLifeColors, WrappedEdges> GameLifeMatrix;
+template <class ColorPolicy, class EdgePolicy>
+class LifeEngine : public Matrix
+{
+public:
+    // highPrecisionTrails: blend trails in a fixed-point accumulation buffer instead of in 565
+    LifeEngine(int initDensityPercentage = 45, bool highPrecisionTrails = false);
+    ~LifeEngine();
+    void initialise() override;
+    void calcNewStates() override;
+    const char *getName() const override { return ColorPolicy::name(); }
+
+    // change the birth/survival rules e.g. "B3/S23". this will be applied at start of next frame.
+    // returns false if the rulestring is invalid. thread-safe
+    bool setRule(const char *ruleString);
+
+    // per-frame counters: tiles whose states were evaluated / whose colors were blended.
+    // written by calcNewStates(), readable from any task
+    int getTilesEvaluated() { return tilesEvaluated.load(std::memory_order_relaxed); }
+    int getTilesBlended() { return tilesBlended.load(std::memory_order_relaxed); }
+    // log the tile counters of the last frame
+    void logFrameStats() override;
+
+    // bytes used by the high-precision trail buffer, 0 if not enabled
+    size_t getAccumulatorBytes() { return accumulator ? accumulator->getMemoryBytes() : 0; }
+
+    // passed on to the colour policy, which may ignore them
+    void setHue(uint16_t hue) override
+    {
+        if (colors.setHue(hue))
+            updateStateColors();
+    }
+    void nextPalette() override
+    {
+        colors.nextPalette();
+    }
+    void setPaletteTransitionFrames(int frames) override
+    {
+        colors.setTransitionFrames(frames);
+    }
+
+private:
+    int initDensityPercentage = 45; // percentage chance of a cell being alive at start
+
+    // bit-packed boards to hold alive/dead cell states
+    LifeBoard boardPrimary;
+    LifeBoard boardSecondary;
+
+    // birth/survival rules with chance-based under/overpopulation deaths. only used by calcNewStates()
+    LifeRule rule;
+    // the rule last set, copied into rule at the start of a frame when flagged
+    SemaphoreHandle_t ruleMutex; // protects requestedRule
+    LifeRule requestedRule;
+    std::atomic<bool> ruleChangeRequested;
+
+    // tiles whose colors have converged, so blending can be skipped
+    uint32_t settledColorTiles = 0;
+    std::atomic<int> tilesEvaluated;
+    std::atomic<int> tilesBlended;
+
+    // per-frame state shared by the band jobs, and each band's results
+    bool baseColorsChanged = true;
+    FastRandom bandRngs[LifeBoard::BANDS];
+    uint32_t bandSettledColorTiles[LifeBoard::BANDS] = {0};
+    int bandTilesBlended[LifeBoard::BANDS] = {0};
+
+    ColorPolicy colors;
+
+    // Current frame colors, indexed by LifeCellState
+    uint16_t stateColors[CELL_STATE_COUNT] = {0, 0, 0, 0};
+    // state colors used in the last blend, to spot when settled tiles need re-blending
+    uint16_t lastStateColors[CELL_STATE_COUNT] = {0, 0, 0, 0};
+    // the same colors at full precision for the accumulation buffer, and those used in the last blend
+    ColorAccumulator::Cell stateCells[CELL_STATE_COUNT] = {};
+    ColorAccumulator::Cell lastStateCells[CELL_STATE_COUNT] = {};
+
+    // optional high-precision trail colors, blended instead of the 565 buffers. null if not enabled
+    ColorAccumulator *accumulator = nullptr;
+
+    // influence of previous cell color on new color (0-255)
+    // 0= no influence, 255 = full influence
+    uint8_t prevCellInfluence = 200;
+
+    // update the state colors from the colour policy
+    void updateStateColors();
+
+    // calculate the new states and colors of one band (tile column)
+    void calcBand(int band);
+    // a static function wrapper we can use as a job function
+    static void bandJob(void *context, int band)
+    {
+        static_cast<LifeEngine *>(context)->calcBand(band);
+    }
+
+    // blend the new colors of one tile. returns true if no color changed
+    bool calcTileColors(int tileX, int tileY);
+    // copy the colors of one tile unchanged
+    void copyTileColors(int tileX, int tileY);
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "LifeRule.h"
+
+const uint16_t LifeRule::CERTAIN;
+
+LifeRule::LifeRule(const char *ruleString)
+{
+    if (!setRuleString(ruleString))
+    {
+        Logger::printf("LifeRule: invalid rule '%s', using %s\n", ruleString, LIFE_RULE_CONWAY);
+        setRuleString(LIFE_RULE_CONWAY);
+    }
+}
+
+// parse a B/S rulestring. 'B' and 'S' sections can be in either order, separated by '/'
+bool LifeRule::setRuleString(const char *newRuleString)
+{
+    if (newRuleString == nullptr)
+        return false;
+
+    uint16_t newBirthMask = 0;
+    uint16_t newSurviveMask = 0;
+    bool hasBirth = false;
+    bool hasSurvive = false;
+    uint16_t *currentMask = nullptr;
+
+    for (const char *c = newRuleString; *c != '\0'; c++)
+    {
+        if (*c == 'B' || *c == 'b')
+        {
+            if (hasBirth)
+                return false;
+            hasBirth = true;
+            currentMask = &newBirthMask;
+        }
+        else if (*c == 'S' || *c == 's')
+        {
+            if (hasSurvive)
+                return false;
+            hasSurvive = true;
+            currentMask = &newSurviveMask;
+        }
+        else if (*c >= '0' && *c <= '8' && currentMask != nullptr)
+        {
+            *currentMask |= (1u << (*c - '0'));
+        }
+        else if (*c != '/')
+        {
+            return false;
+        }
+    }
+    if (!hasBirth || !hasSurvive)
+        return false;
+
+    birthMask = newBirthMask;
+    surviveMask = newSurviveMask;
+    compile();
+    return true;
+}
+
+void LifeRule::setSurvivalChance(int minNeighbours, int maxNeighbours, uint16_t chance)
+{
+    minNeighbours = constrain(minNeighbours, 0, 8);
+    maxNeighbours = constrain(maxNeighbours, 0, 8);
+    for (int n = minNeighbours; n <= maxNeighbours; n++)
+        survivalChance[n] = (chance > CERTAIN) ? CERTAIN : chance;
+    compile();
+}
+
+void LifeRule::setBirthChance(int minNeighbours, int maxNeighbours, uint16_t chance)
+{
+    minNeighbours = constrain(minNeighbours, 0, 8);
+    maxNeighbours = constrain(maxNeighbours, 0, 8);
+    for (int n = minNeighbours; n <= maxNeighbours; n++)
+        birthChance[n] = (chance > CERTAIN) ? CERTAIN : chance;
+    compile();
+}
+
+// rebuild the transition table, masks and kernel from the rule & chances
+void LifeRule::compile()
+{
+    chanceGroupCount = 0;
+    for (int n = 0; n <= 8; n++)
+    {
+        uint16_t countBit = 1u << n;
+        transition[0][n] = (birthMask & countBit) ? CERTAIN : birthChance[n];
+        transition[1][n] = (surviveMask & countBit) ? CERTAIN : survivalChance[n];
+
+        for (int alive = 0; alive < 2; alive++)
+        {
+            uint16_t chance = transition[alive][n];
+            if (chance == 0 || chance == CERTAIN)
+                continue;
+
+            // add to the group with the same chance, or start a new group
+            int group = 0;
+            while (group < chanceGroupCount && chanceGroups[group].chance != chance)
+                group++;
+            if (group == chanceGroupCount)
+            {
+                chanceGroups[group].chance = chance;
+                chanceGroups[group].probability = FastRandom::probability(chance, CERTAIN);
+                chanceGroups[group].countMask[0] = 0;
+                chanceGroups[group].countMask[1] = 0;
+                chanceGroupCount++;
+            }
+            chanceGroups[group].countMask[alive] |= countBit;
+        }
+    }
+
+    // rebuild canonical rulestring
+    int len = 0;
+    ruleString[len++] = 'B';
+    for (int n = 0; n <= 8; n++)
+        if (birthMask & (1u << n))
+            ruleString[len++] = '0' + n;
+    ruleString[len++] = '/';
+    ruleString[len++] = 'S';
+    for (int n = 0; n <= 8; n++)
+        if (surviveMask & (1u << n))
+            ruleString[len++] = '0' + n;
+    ruleString[len] = '\0';
+
+    // pick a specialised kernel if there is one for this rule
+    if (strcmp(ruleString, LIFE_RULE_CONWAY) == 0)
+        kernel = KERNEL_CONWAY;
+    else if (strcmp(ruleString, LIFE_RULE_HIGHLIFE) == 0)
+        kernel = KERNEL_HIGHLIFE;
+    else if (strcmp(ruleString, LIFE_RULE_DAY_AND_NIGHT) == 0)
+        kernel = KERNEL_DAY_AND_NIGHT;
+    else if (strcmp(ruleString, LIFE_RULE_SEEDS) == 0)
+        kernel = KERNEL_SEEDS;
+    else
+        kernel = KERNEL_GENERIC;
+}
@@ -0,0 +1,89 @@
+#ifndef LIFERULE_H
+#define LIFERULE_H
+
+#pragma once
+
+#include <Arduino.h>
+#include "Logger.h"
+#include "FastRandom.h"
+
+// common Life-like rules in B/S notation
+#define LIFE_RULE_CONWAY "B3/S23"
+#define LIFE_RULE_HIGHLIFE "B36/S23"
+#define LIFE_RULE_DAY_AND_NIGHT "B3678/S34678"
+#define LIFE_RULE_SEEDS "B2/S"
+
+// Runtime-configurable Life-like rule.
+// A B/S rulestring (e.g. "B36/S23") sets which neighbour counts give birth and survival.
+// On top of that, cells the rule would kill (or leave dead) can be given a chance per
+// neighbour count of surviving (or being born). Everything is compiled into a 9-entry
+// transition table per state: chance (0-1000) of being alive next generation.
+// Usage:
+//     LifeRule rule(LIFE_RULE_HIGHLIFE);
+//     rule.setSurvivalChance(0, 1, 10); // live cells with 0-1 neighbours have 1% chance to survive
+class LifeRule
+{
+public:
+    static const uint16_t CERTAIN = 1000; // chances are out of 1000
+
+    // kernels that LifeBoard has compile-time specialised versions of
+    enum Kernel
+    {
+        KERNEL_GENERIC,
+        KERNEL_CONWAY,
+        KERNEL_HIGHLIFE,
+        KERNEL_DAY_AND_NIGHT,
+        KERNEL_SEEDS
+    };
+
+    LifeRule(const char *ruleString = LIFE_RULE_CONWAY);
+
+    // parse a B/S rulestring e.g. "B36/S23" or "S23/B36". returns false and keeps the
+    // current rule if the string is invalid. Existing survival/birth chances are kept.
+    bool setRuleString(const char *ruleString);
+
+    // chance (0-1000) that a live cell with this many neighbours survives when the rule says it dies
+    void setSurvivalChance(int minNeighbours, int maxNeighbours, uint16_t chance);
+    // chance (0-1000) that a dead cell with this many neighbours is born when the rule says it stays dead
+    void setBirthChance(int minNeighbours, int maxNeighbours, uint16_t chance);
+
+    // the compiled transition table: chance (0-1000) of a cell being alive next generation
+    uint16_t getTransition(bool alive, int neighbours) const { return transition[alive][neighbours]; }
+
+    // bit masks over neighbour counts (bit n = n neighbours)
+    uint16_t getBirthMask() const { return birthMask; }     // dead cells certainly born
+    uint16_t getSurviveMask() const { return surviveMask; } // live cells certainly survive
+
+    // neighbour counts whose outcome is decided by a random draw, grouped by chance
+    // so one random mask covers every count with the same chance
+    struct ChanceGroup
+    {
+        uint16_t chance;       // 0-1000
+        uint16_t probability;  // same chance in 1/65536ths, for FastRandom::bernoulliMask()
+        uint16_t countMask[2]; // neighbour counts for dead [0] and live [1] cells
+    };
+    int getChanceGroupCount() const { return chanceGroupCount; }
+    const ChanceGroup &getChanceGroup(int index) const { return chanceGroups[index]; }
+
+    Kernel getKernel() const { return kernel; }
+    // rule in B/S notation
+    const char *getRuleString() const { return ruleString; }
+
+private:
+    uint16_t birthMask = 0;
+    uint16_t surviveMask = 0;
+    uint16_t survivalChance[9] = {0};
+    uint16_t birthChance[9] = {0};
+
+    // compiled values
+    uint16_t transition[2][9];
+    ChanceGroup chanceGroups[18];
+    int chanceGroupCount = 0;
+    Kernel kernel = KERNEL_GENERIC;
+    char ruleString[24];
+
+    // rebuild the transition table, masks and kernel from the rule & chances
+    void compile();
+};
+
+#endif
@@ -1,5 +1,32 @@
 #include "Matrix.h"
 
+Matrix::Matrix(FrameFormat frameFormat)
+    : frameFormat(frameFormat),
+      rng(esp_random()), // seed from internal heat-based random generator
+      jobSystem(nullptr)
+{
+    // only the frames of our format are allocated
+    if (frameFormat == FRAME_FORMAT_INDEXED8)
+    {
+        indexPrimary = new IndexFrameBuffer();
+        indexPrimary->fill(0);
+    }
+    else
+    {
+        bufferPrimary = new FrameBuffer();
+        bufferSecondary = new FrameBuffer();
+        bufferPrimary->fill(0);
+        bufferSecondary->fill(0);
+    }
+}
+
+Matrix::~Matrix()
+{
+    delete bufferPrimary;
+    delete bufferSecondary;
+    delete indexPrimary;
+}
+
 // convert 24-bit RGB to 16-bit RGB565
 uint16_t Matrix::rgbTo565(uint8_t r, uint8_t g, uint8_t b)
 {
@@ -8,13 +35,20 @@ uint16_t Matrix::rgbTo565(uint8_t r, uint8_t g, uint8_t b)
 
 // convert HSV to 565 ( hue : 0-65535,  sat : 0-255,  val : 0-255)
 uint16_t Matrix::hsvTo565(uint16_t hue, uint8_t sat, uint8_t val)
+{
+    uint8_t r, g, b;
+    hsvToRGB(hue, sat, val, r, g, b);
+    return rgbTo565(r, g, b);
+}
+
+// convert HSV to 8-bit r, g, b ( hue : 0-65535,  sat : 0-255,  val : 0-255)
+void Matrix::hsvToRGB(uint16_t hue, uint8_t sat, uint8_t val, uint8_t &r, uint8_t &g, uint8_t &b)
 {
     uint32_t hsvColor = Adafruit_NeoPixel::Adafruit_NeoPixel::ColorHSV(hue, sat, val);
   //  uint32_t hsvColor = Adafruit_NeoPixel::gamma32(Adafruit_NeoPixel::ColorHSV(hue, sat, val));
-    uint8_t r = (hsvColor >> 16) & 0xFF;
-    uint8_t g = (hsvColor >> 8) & 0xFF;
-    uint8_t b = hsvColor & 0xFF;
-    return rgbTo565(r, g, b);
+    r = (hsvColor >> 16) & 0xFF;
+    g = (hsvColor >> 8) & 0xFF;
+    b = hsvColor & 0xFF;
 }
 
 // extract 8-bit r, g, b from 16-bit 565 color
@@ -6,25 +6,57 @@
 #include <Arduino.h>
 #include <Adafruit_NeoPixel.h>
 #include "Logger.h"
+#include "FastRandom.h"
+#include "FrameBuffer.h"
+#include "JobSystem.h"
+#include "TimeHistogram.h"
 
 // Abstract base class for matrix-based algorithms
+// Matrices whose colours all come from one palette can use FRAME_FORMAT_INDEXED8: they
+// write palette indices, at half the memory, and point framePalette at 256 RGB565 colours.
+// Indexed matrices redraw every frame from scratch, so they keep no previous frame.
+// The indices and palette are queued for the display as they are, and only turned into
+// colours as the frame is composed, so changing or animating the palette costs 256 colours,
+// not a pass over every pixel.
 class Matrix
 {
 public:
-    static const int MATRIX_ARRAY_WIDTH = 64;
-    static const int MATRIX_ARRAY_HEIGHT = 32;
+    static const int MATRIX_ARRAY_WIDTH = FrameBuffer::WIDTH;
+    static const int MATRIX_ARRAY_HEIGHT = FrameBuffer::HEIGHT;
 
-    Matrix() {}          // Inline empty constructor
-    virtual ~Matrix() {} // Inline empty destructor
+    Matrix(FrameFormat frameFormat = FRAME_FORMAT_RGB565);
+    virtual ~Matrix();
 
     // pure virtual functions to be implemented by derived classes
     virtual void initialise() = 0;    // initialize the matrix states
     virtual void calcNewStates() = 0; // calculate new states
 
+    // name for logging
+    virtual const char *getName() const { return "Matrix"; }
+
     // default implementation does nothing, override in child classes that support palettes
     virtual void nextPalette() {} 
+    // frames over which palette changes morph from the old palette to the new one (0 = instant).
+    // default implementation does nothing, override in child classes that support palettes
+    virtual void setPaletteTransitionFrames(int frames) {}
     // default implementation does nothing, override in child classes that support hue changes
     virtual void setHue(uint16_t hue) {}
+    // log counters of the last frame calculated, from any task. default implementation
+    // does nothing, override in child classes that count their work e.g. tiles skipped
+    virtual void logFrameStats() {}
+
+    // restart this matrix's random sequence, for reproducible runs. call initialise() after.
+    void setSeed(uint32_t seed)
+    {
+        rng.seed(seed);
+    }
+
+    // job system to spread calcNewStates() across cores. matrices that split their work into
+    // jobs (see runJobs()) use it, the rest ignore it. null to calculate on the calling task only
+    void setJobSystem(JobSystem *jobSystem)
+    {
+        this->jobSystem.store(jobSystem);
+    }
 
     // whether we're cycling or static e.g. palettes, hue changes etc.
     void setCycling(bool cycling)
@@ -36,18 +68,50 @@ public:
         return this->cycling.load();
     }
 
+    FrameFormat getFrameFormat() const
+    {
+        return frameFormat;
+    }
+
+    // read-only view of the current frame, bufferPrimary or indexPrimary and framePalette.
+    // valid until the next calcNewStates(), so read it from the same task
+    FrameView getFrame() const
+    {
+        if (frameFormat == FRAME_FORMAT_INDEXED8)
+            return FrameView(indexPrimary, framePalette);
+        return FrameView(bufferPrimary);
+    }
+
     // common interface to get cell colors
     uint16_t getCellColor(int x, int y)
     {
         if (x < 0 || x >= MATRIX_ARRAY_WIDTH || y < 0 || y >= MATRIX_ARRAY_HEIGHT)
             return 0x0000; // out of bounds
-        return bufferPrimary[x][y];
+        if (frameFormat == FRAME_FORMAT_INDEXED8)
+            return (framePalette != nullptr) ? framePalette[indexPrimary->at(x, y)] : 0x0000; // no palette yet
+        return bufferPrimary->at(x, y);
     }
+    // black for indexed matrices, which keep no previous frame
     uint16_t getPrevCellColor(int x, int y)
     {
         if (x < 0 || x >= MATRIX_ARRAY_WIDTH || y < 0 || y >= MATRIX_ARRAY_HEIGHT)
             return 0x0000; // out of bounds
-        return bufferSecondary[x][y];
+        if (frameFormat == FRAME_FORMAT_INDEXED8)
+            return 0x0000;
+        return bufferSecondary->at(x, y);
+    }
+
+    // times taken to calculate and write this matrix's frames, in µs. recorded by whoever
+    // calculates them (one task only), readable from any task
+    TimeHistogram &getCalcTimes()
+    {
+        return calcTimes;
+    }
+
+    // bytes used by this matrix's frames
+    size_t getFrameBytes() const
+    {
+        return (frameFormat == FRAME_FORMAT_INDEXED8) ? sizeof(IndexFrameBuffer) : 2 * sizeof(FrameBuffer);
     }
 
     // set whether drawing in background mode (lower brightness) or foreground mode (higher brightness)
@@ -67,21 +131,51 @@ public:
     // helper functions available publicly:
 
     // convert 24-bit RGB to 16-bit RGB565
-    uint16_t rgbTo565(uint8_t r, uint8_t g, uint8_t b);
+    static uint16_t rgbTo565(uint8_t r, uint8_t g, uint8_t b);
     // convert HSV to 565 ( hue : 0-65535,  sat : 0-255,  val : 0-255)
-    uint16_t hsvTo565(uint16_t hue, uint8_t sat, uint8_t val);
+    static uint16_t hsvTo565(uint16_t hue, uint8_t sat, uint8_t val);
+    // convert HSV to 8-bit r, g, b ( hue : 0-65535,  sat : 0-255,  val : 0-255)
+    static void hsvToRGB(uint16_t hue, uint8_t sat, uint8_t val, uint8_t &r, uint8_t &g, uint8_t &b);
     // extract 8-bit r, g, b from 16-bit 565 color
-    void getRGBFrom565(uint16_t color, uint8_t &r, uint8_t &g, uint8_t &b);
+    static void getRGBFrom565(uint16_t color, uint8_t &r, uint8_t &g, uint8_t &b);
 
 protected:
-    // 2D buffers to hold cell states
-    std::array<std::array<uint16_t, MATRIX_ARRAY_HEIGHT>, MATRIX_ARRAY_WIDTH> bufferPrimary;
-    std::array<std::array<uint16_t, MATRIX_ARRAY_HEIGHT>, MATRIX_ARRAY_WIDTH> bufferSecondary;
+    const FrameFormat frameFormat;
+
+    // row-major frames to hold cell colors, FRAME_FORMAT_RGB565 only (null otherwise)
+    FrameBuffer *bufferPrimary = nullptr;
+    FrameBuffer *bufferSecondary = nullptr;
+    // row-major frame to hold cell palette indices, FRAME_FORMAT_INDEXED8 only (null otherwise)
+    IndexFrameBuffer *indexPrimary = nullptr;
+    // FRAME_FORMAT_INDEXED8: the 256 RGB565 colours of the indices, set by the child class.
+    // may change between frames, but not while the frame is read through getFrame()
+    const uint16_t *framePalette = nullptr;
 
     std::atomic<bool> backgroundMode;             // drawing in background or foreground
     std::atomic<float> currentRelativeBrightness; // current brightness factor based on mode
     std::atomic<bool> cycling;                    // whether currently cycling through palette or hue changes
 
+    FastRandom rng; // per-matrix random generator for the render path
+
+    std::atomic<JobSystem *> jobSystem; // optional, see setJobSystem()
+    TimeHistogram calcTimes;            // see getCalcTimes()
+
+    // run function(context, job) for job 0..jobCount-1 on the job system if there is one,
+    // otherwise in turn on this task. returns when every job has finished
+    void runJobs(int jobCount, JobSystem::JobFunction function, void *context)
+    {
+        JobSystem *jobs = jobSystem.load();
+        if (jobs != nullptr)
+        {
+            jobs->run(jobCount, function, context);
+            return;
+        }
+        for (int job = 0; job < jobCount; job++)
+        {
+            function(context, job);
+        }
+    }
+
     // reltive brightness factors: set these in child classes as needed
     // e.g. 0.3f : background is 30% of the brightness of foreground
     float backgroundModeRelativeBrightness = 0.5f; // (0-1.0f) brightness factor for background mode
@@ -6,12 +6,23 @@ MatrixDriver::MatrixDriver(int fps, Panel *panel, Matrix *matrix, GY21Sensor *gy
 {
     this->panel = panel;
     this->matrixCurrent = matrix;
+    // frames are calculated on the producer's core and the other one
+    this->jobSystem = new JobSystem(FRAME_JOB_WORKERS, 1 - FRAME_PRODUCER_CORE);
+    if (matrix != nullptr)
+        matrix->setJobSystem(jobSystem);
     this->gy21Sensor = gy21Sensor;
     this->setPanelBrightness(255); // default brightness
     this->enabled.store(false);
     this->textEnabled.store(true);
     this->backgroundEnabled.store(true);
     this->colorChangeRequested.store(false);
+    this->framesTimed.store(0);
+    this->deadlineMisses.store(0);
+
+    // frames are composed from the matrix frame with the texts over it
+    compositor.addLayer(&backgroundLayer);
+    compositor.addLayer(&temperatureLayer);
+    compositor.addLayer(&humidityLayer);
 
     // initialise brightness to sync values. brightness normally set by potentiometer in runtime
     if (panel != nullptr)
@@ -70,7 +81,21 @@ MatrixDriver::MatrixDriver(int fps, Panel *panel, Matrix *matrix, GY21Sensor *gy
         &updateTaskHandle,               // Task handle
         1                                // Core to run the task on (0 or 1)
     );
+    // and a task to calculate the matrix frames ahead on the other core
+    xTaskCreatePinnedToCore(
+        MatrixDriver::producerTaskWrapper, // Function that should be called
+        "Matrix Producer Task",            // Name of the task (for debugging)
+        10000,                             // Stack size (bytes)
+        this,                              // Parameter to pass
+        1,                                 // Task priority // low priority, below WiFi on the same core
+        &producerTaskHandle,               // Task handle
+        FRAME_PRODUCER_CORE                // Core to run the task on (0 or 1)
+    );
     delay(100);
+    if (producerTaskHandle == NULL)
+    {
+        Logger::println("Failed to create MatrixDriver producerTask");
+    }
     if (updateTaskHandle == NULL)
     {
         Logger::println("Failed to create MatrixDriver updateTask");
@@ -80,6 +105,9 @@ MatrixDriver::MatrixDriver(int fps, Panel *panel, Matrix *matrix, GY21Sensor *gy
         // pause the task till it's needed
         Logger::println("MatrixDriver update task created, suspending it");
         pause();
+        // new sensor values wake the task when it's waiting for changes
+        if (gy21Sensor != nullptr)
+            gy21Sensor->setChangeListener(updateTaskHandle);
     }
 }
 
@@ -90,30 +118,34 @@ void MatrixDriver::setFPS(int fps)
     this->updateIntervalMS.store(1000 / fps);
     this->fpsChanged.store(true); // flag for task to recalc timing
     Logger::printf("MatrixDriver:updateIntervalMS set to %d ms", this->updateIntervalMS.load());
+    wakeUpdateTask();
 }
 
 // set panel brightness 0-255..note this is only applied to panel in the update task
 void MatrixDriver::setPanelBrightness(uint8_t brightness)
 {
     this->panelBrightness.store(brightness);
+    wakeUpdateTask();
 }
 
 // enable/disable text drawing
 void MatrixDriver::enableTextDrawing(bool enable)
 {
     this->textEnabled.store(enable);
+    wakeUpdateTask();
 }
 
 // enable/disable background drawing
 void MatrixDriver::enableBackgroundDrawing(bool enable)
 {
     this->backgroundEnabled.store(enable);
-    // if turning off background drawing, ensure we clear screen first
+    // the update task composes the frame without the background, no need to clear the screen
     if (xSemaphoreTake(matrixMutex, portMAX_DELAY) == pdTRUE)
     {
-        panel->clearScreen();
+        frameGeneration++; // frames queued before now are out of date
         xSemaphoreGive(matrixMutex);
     }
+    wakeUpdateTask();
 }
 
 // safely set a new matrix to use
@@ -121,6 +153,7 @@ void MatrixDriver::setMatrix(Matrix *newMatrix)
 {
     if (!newMatrix)
         return;
+    newMatrix->setJobSystem(jobSystem);
     if (matrixMutex == NULL)
     {
         Logger::println("WARNING: matrixMutex not created; setting matrix without lock");
@@ -130,10 +163,67 @@ void MatrixDriver::setMatrix(Matrix *newMatrix)
     if (xSemaphoreTake(matrixMutex, portMAX_DELAY) == pdTRUE)
     {
         matrixCurrent = newMatrix;
+        frameGeneration++; // drop frames queued from the previous matrix
         xSemaphoreGive(matrixMutex);
     }
 }
 
+// the producer task function: calculates the matrix states ahead of the display, and
+// pushes the finished frames into the frame queue. waits for the display when it's full
+void MatrixDriver::producerTask()
+{
+    while (true)
+    {
+        // nothing to calculate while paused or not drawing the background
+        if (!enabled.load() || !backgroundEnabled.load())
+        {
+            vTaskDelay(pdMS_TO_TICKS(50));
+            continue;
+        }
+
+        QueuedFrame *slot = frameQueue.beginWrite();
+        if (slot == nullptr)
+        {
+            // queue full, wait for the display task to take a frame
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        // get matrix pointer and its frame generation safely
+        Matrix *matrix = nullptr;
+        uint32_t generation = 0;
+        if (xSemaphoreTake(matrixMutex, portMAX_DELAY) == pdTRUE)
+        {
+            matrix = this->matrixCurrent;
+            generation = this->frameGeneration;
+            xSemaphoreGive(matrixMutex);
+        }
+        if (!matrix)
+        {
+            vTaskDelay(1);
+            continue;
+        }
+
+        // change palettes if needed and reset flag
+        if (colorChangeRequested.exchange(false))
+        {
+            matrix->nextPalette();      // if implemented, otherwise this will do nothing
+            matrix->setHue(hue.load()); // if implemented
+        }
+
+        // calc new matrix states and queue the frame, as it is: indexed frames are
+        // looked up in their palette when the update task composes them
+        {
+            TRACE_ZONE("Calc");
+            unsigned long tStart = micros();
+            matrix->calcNewStates();
+            slot->write(matrix->getFrame());
+            matrix->getCalcTimes().record(micros() - tStart); // per matrix, only recorded here
+        }
+        frameQueue.commitWrite(generation);
+    }
+}
+
 // the main update task function that updates the matrix display
 // order of operations:
 // 1. SYNC TO RTOS TIMING
@@ -141,13 +231,13 @@ void MatrixDriver::setMatrix(Matrix *newMatrix)
 // 3. SET MATRIX POINTER SAFELY
 // 4. FLIP BUFFERS SO BACK BUFFER PUSHED TO DISPLAY AND WE DRAW TO THE BACK BUFFER
 // 5. WAIT FOR FPS DELAY HERE - AT LEAST ONE FULL REFRESH
-// 6. CLEAR BACK BUFFER
-// 7. UPDATE PANEL BRIGHTNESS IF NEEDED
-// 8. READ INPUTS
-// 9. CALC NEW MATRIX STATES
-// 10. DRAW CELLS TO BACK BUFFER
-// 11. DRAW TEXT TO BACK BUFFER
-// 12. TIMING LOGGING
+// 6. UPDATE PANEL BRIGHTNESS IF NEEDED
+// 7. READ INPUTS
+// 8. TAKE NEXT FRAME CALCULATED BY THE PRODUCER TASK
+// 9. SET TEXT LAYERS
+// 10. COMPOSE ALL LAYERS INTO ONE FRAME (LOOKING INDEXED FRAMES UP IN THEIR PALETTE)
+// 11. DRAW DAMAGED ROWS OF COMPOSED FRAME TO BACK BUFFER
+// 12. TIMING
 void MatrixDriver::updateTask()
 {
     bool wasEnabled = false;
@@ -160,7 +250,11 @@ void MatrixDriver::updateTask()
     TickType_t minSwapPeriod;
     // Never flip buffers faster than the panel can display them,& never update slower than the requested FPS.
     TickType_t effectivePeriod;
-    unsigned long tStart, tBuffering, tRead, tCalc, tDraw, tText;
+    unsigned long tFrame, tSwap, tStart, tRead, tFetch, tCompose, tDraw;
+    // damage tracking: rows written to the panel last frame, and whether the back buffer
+    // was drawn to, so needs showing. the other buffer still needs last frame's rows
+    uint32_t previousRows = 0;
+    bool backBufferDrawn = false;
 
     while (true)
     {
@@ -217,20 +311,27 @@ void MatrixDriver::updateTask()
             panel->setBrightness(panelBrightness.load());
             lastWake = xTaskGetTickCount(); // prevent “catch up”
             wasEnabled = true;
+            // so draw everything again
+            compositor.invalidate();
+            previousRows = 0;
+            backBufferDrawn = false;
         }
 
         /////////////////////////////////
         // Normal update operations below
         // 3. SET MATRIX POINTER SAFELY
         Matrix *matrix = nullptr;
+        uint32_t generation = 0; // frames from the producer must be from this generation
         if (matrixMutex == NULL)
         {
             Logger::println("MatrixDriver: WARNING: matrixMutex not created; using matrix without lock");
             matrix = this->matrixCurrent;
+            generation = this->frameGeneration;
         }
         else if (xSemaphoreTake(matrixMutex, portMAX_DELAY) == pdTRUE)
         {
             matrix = this->matrixCurrent;
+            generation = this->frameGeneration;
             xSemaphoreGive(matrixMutex);
         }
 
@@ -241,32 +342,50 @@ void MatrixDriver::updateTask()
         }
 
         // 4. FLIP BUFFERS SO BACK BUFFER PUSHED TO DISPLAY AND WE DRAW TO THE BACK BUFFER
-        if (panel->isDoubleBuffered())
+        // only if something was drawn to it last frame, otherwise both buffers are the same
+        tFrame = micros();
+        if (panel->isDoubleBuffered() && backBufferDrawn)
         {
             panel->swapDMABuffers();
         }
+        bool swapped = backBufferDrawn;
+        backBufferDrawn = false;
+        tSwap = micros();
 
         // 5. WAIT FOR FPS DELAY HERE - AT LEAST ONE FULL REFRESH
         // Wait until the next frame boundary. This enforces the effective FPS *and* ensures the DMA engine
         // has completed at least one full panel refresh before we write to the back buffer.
         // This is important to avoid visual tearing due to DMA reading from buffer while we write to it
-        vTaskDelayUntil(&lastWake, effectivePeriod);
+        // With no background, the frame only changes when something is set e.g. the sensor text.
+        // If nothing is left to draw or show, sleep until one of those wakes us instead.
+        if (!backgroundEnabled.load() && !swapped && previousRows == 0)
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IDLE_WAKE_MS));
+            lastWake = xTaskGetTickCount(); // prevent “catch up”
+        }
+        else
+        {
+            // pdFALSE if it didn't block, as the last frame overran the period
+            if (xTaskDelayUntil(&lastWake, effectivePeriod) == pdFALSE)
+            {
+                deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
 
         tStart = micros(); // start timing after delay
-        // 6. CLEAR BACK BUFFER
-        panel->clearScreen();
-        tBuffering = micros();
+        TRACE_ZONE("Frame"); // to the end of the frame
 
-        // 7. UPDATE PANEL BRIGHTNESS IF NEEDED
+        // 6. UPDATE PANEL BRIGHTNESS IF NEEDED
         if (panel->getBrightness() != panelBrightness.load())
         {
             panel->setBrightness(panelBrightness.load());
         }
 
-        // 8. READ INPUTS
+        // 7. READ INPUTS
         // if temp or humidity has changed since last read, then update text
         if (gy21Sensor->hasValueChanged())
         {
+            TRACE_ZONE("Sensor text");
             char temporaryTextBuffer[16];
             char temporaryHumidityBuffer[16];
 
@@ -277,110 +396,172 @@ void MatrixDriver::updateTask()
         }
         tRead = micros();
 
-        // if background drawing is enabled, then update matrix states & draw cells
+        // 8. TAKE NEXT FRAME CALCULATED BY THE PRODUCER TASK IF BACKGROUND DRAWING IS ENABLED
+        // (the current frame again if the next isn't ready)
+        FrameView frame; // none
+        bool isNewFrame = false;
         if (backgroundEnabled.load())
         {
-            // change palettes if needed and reset flag
-            if (colorChangeRequested.exchange(false))
-            {
-                matrix->nextPalette();      // if implemented, otherwise this will do nothing
-                matrix->setHue(hue.load()); // if implemented
-            }
+            const QueuedFrame *queued = frameQueue.nextFrame(generation, &isNewFrame);
+            if (queued != nullptr)
+                frame = queued->view();
+            // let the producer know there's room for another frame
+            xTaskNotifyGive(producerTaskHandle);
+        }
+        backgroundLayer.setFrame(frame, isNewFrame); // no background layer (black) if there's no frame
+        tFetch = micros();
 
-            // 9. CALC NEW MATRIX STATES
-            matrix->calcNewStates();
-            tCalc = micros();
+        // 9. SET TEXT LAYERS IF ENABLED
+        updateTextLayers();
 
-            // 10. DRAW CELLS TO BACK BUFFER
-            drawCellsToPanel(matrix);
-            tDraw = micros();
+        // 10. COMPOSE ALL LAYERS INTO ONE FRAME
+        // only the rows damaged since last frame
+        uint32_t damagedRows = compositor.compose(composedFrame);
+        tCompose = micros();
+
+        // 11. DRAW DAMAGED ROWS OF COMPOSED FRAME TO BACK BUFFER
+        // every pixel of a row is written, so the back buffer needn't be cleared first.
+        // the back buffer was last drawn two frames ago, so it needs last frame's rows too
+        uint32_t rows = damagedRows;
+        if (panel->isDoubleBuffered())
+        {
+            rows |= previousRows;
         }
-        else // background remains cleared (black)
+        previousRows = damagedRows;
+        if (rows != 0)
         {
-            tCalc = micros();
-            tDraw = tCalc;
+            panel->writeRows(composedFrame, rows);
+            backBufferDrawn = true;
+            rowsWritten += __builtin_popcount(rows);
         }
-
-        // 11. DRAW TEXT TO BACK BUFFER IF ENABLED
-        if (textEnabled.load())
+        else
         {
-            drawAllTextToPanel();
+            framesSuppressed++; // nothing changed, skip the draw and the swap
         }
-        tText = micros();
-
-        // 12. TIMING LOGGING
-        static uint updateEveryNFrames = 60;
-        static uint16_t frameCount = 0;
-        static unsigned long lastFrameTime = 0;
-
-        if (++frameCount >= updateEveryNFrames)
+        tDraw = micros();
+
+        // 12. TIMING
+        // each stage's time into its histogram, logged every FRAME_STATS_LOG_FRAMES frames
+        stageTimes[STAGE_SWAP].record(tSwap - tFrame);
+        stageTimes[STAGE_WAIT].record(tStart - tSwap);
+        stageTimes[STAGE_READ].record(tRead - tStart);
+        stageTimes[STAGE_FETCH].record(tFetch - tRead);
+        stageTimes[STAGE_COMPOSE].record(tCompose - tFetch);
+        stageTimes[STAGE_DRAW].record(tDraw - tCompose);
+        stageTimes[STAGE_WORK].record(tDraw - tStart);
+        if (framesTimed.fetch_add(1, std::memory_order_relaxed) % FRAME_STATS_LOG_FRAMES == FRAME_STATS_LOG_FRAMES - 1)
         {
-            frameCount = 0;
-            unsigned long workTime = tText - tStart;
-            unsigned long totalFrameTime = tStart - lastFrameTime;
-            unsigned long idleTime = (totalFrameTime > workTime) ? (totalFrameTime - workTime) : 0;
-            float actualFPS = (lastFrameTime > 0) ? (1000000.0f / totalFrameTime) : 0.0f;
-
-            Logger::printf("Timing (µs) - Calc: %lu, Draw: %lu, Text: %lu, Total Work: %lu\n, Idle: %lu, Frame Total: %lu, Actual FPS: %.1f, Idle%%: %.1f%%\n",
-                           tCalc - tRead,
-                           tDraw - tCalc,
-                           tText - tDraw,
-                           workTime,
-                           idleTime,
-                           totalFrameTime,
-                           actualFPS,
-                           (totalFrameTime > 0) ? (100.0f * idleTime / totalFrameTime) : 0.0f);
+            logFrameStats();
         }
-        lastFrameTime = tStart;
     }
 }
 
+const char *MatrixDriver::getStageName(FrameStage stage)
+{
+    static const char *names[STAGE_COUNT] = {"Swap", "Wait", "Read", "Fetch", "Compose", "Draw", "Work"};
+    return names[stage];
+}
+
+// percentiles of each stage and of the current matrix's calculation, plus the counters
+// of the driver and of the matrix.
+// reads everything as it is, so can be called from any task while frames are drawn
+void MatrixDriver::logFrameStats()
+{
+    HistogramSnapshot snapshot;
+    Logger::printf("Frame stages (µs) - frames: %lu, deadline misses: %lu\n",
+                   (unsigned long)framesTimed.load(), (unsigned long)deadlineMisses.load());
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        stageTimes[stage].snapshot(snapshot);
+        Logger::printf("  %-8s min %lu, p50 %lu, p95 %lu, p99 %lu, max %lu\n", getStageName((FrameStage)stage),
+                       (unsigned long)snapshot.min, (unsigned long)snapshot.p50, (unsigned long)snapshot.p95,
+                       (unsigned long)snapshot.p99, (unsigned long)snapshot.max);
+    }
+
+    Matrix *matrix = nullptr;
+    if (xSemaphoreTake(matrixMutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    {
+        matrix = matrixCurrent;
+        xSemaphoreGive(matrixMutex);
+    }
+    if (matrix != nullptr)
+    {
+        // calcNewStates() and queueing the frame in the producer
+        matrix->getCalcTimes().snapshot(snapshot);
+        Logger::printf("  %-8s min %lu, p50 %lu, p95 %lu, p99 %lu, max %lu (%s, %lu frames)\n", "Calc",
+                       (unsigned long)snapshot.min, (unsigned long)snapshot.p50, (unsigned long)snapshot.p95,
+                       (unsigned long)snapshot.p99, (unsigned long)snapshot.max, matrix->getName(),
+                       (unsigned long)snapshot.count);
+        // and what the matrix counted of its last frame, if anything
+        matrix->logFrameStats();
+    }
+
+    // frames suppressed: nothing changed so nothing drawn or swapped. rows: drawn to the panel
+    Logger::printf("Damage - Frames suppressed: %lu, Rows written: %lu\n",
+                   (unsigned long)framesSuppressed,
+                   (unsigned long)rowsWritten);
+    // time each layer took to compose last frame, 0 if hidden or covered
+    Logger::printf("Layers (µs) - %s: %lu, %s: %lu, %s: %lu\n",
+                   backgroundLayer.getName(), backgroundLayer.getCost(),
+                   temperatureLayer.getName(), temperatureLayer.getCost(),
+                   humidityLayer.getName(), humidityLayer.getCost());
+    // producer stalls: waits on a full queue (it's ahead). consumer stalls: frames shown again
+    Logger::printf("Frame queue - Depth: %d, Producer stalls: %lu, Consumer stalls: %lu\n",
+                   frameQueue.getDepth(),
+                   (unsigned long)frameQueue.getProducerStalls(),
+                   (unsigned long)frameQueue.getConsumerStalls());
+    // jobs stolen: jobs that ran on another core than planned e.g. while the display was drawing
+    Logger::printf("Job system - Workers: %d, Jobs stolen: %lu\n",
+                   jobSystem->getWorkerCount(),
+                   (unsigned long)jobSystem->getStolenJobs());
+}
+
 // pause update task safely.
 void MatrixDriver::pause()
 {
     enabled.store(false);
+    wakeUpdateTask();
 }
 
 // resume update task safely,
 void MatrixDriver::resume()
 {
     enabled.store(true);
+    wakeUpdateTask();
 }
 
-// draw all the cells from the matrix to the panel
-void MatrixDriver::drawCellsToPanel(Matrix *matrix)
+// wake the update task if it's sleeping until something changes
+void MatrixDriver::wakeUpdateTask()
 {
-    // draw to panel
-    for (int x = 0; x < MAT_WIDTH; x++)
+    if (updateTaskHandle != NULL)
     {
-        for (int y = 0; y < MAT_HEIGHT; y++)
-        {
-            panel->drawPixel(x, y, matrix->getCellColor(x, y));
-        } // end for y
-    } // end for x
+        xTaskNotifyGive(updateTaskHandle);
+    }
 }
 
-// draw all the temperature and humidity text to the panel
-void MatrixDriver::drawAllTextToPanel()
+// give the text layers this frame's temperature and humidity text, hidden if text is disabled
+void MatrixDriver::updateTextLayers()
 {
-    // draw temperature text from GY21Sensor
+    bool enabled = textEnabled.load();
+    temperatureLayer.setEnabled(enabled);
+    humidityLayer.setEnabled(enabled);
+    if (!enabled)
+        return;
+
+    // temperature text from GY21Sensor
     if (xSemaphoreTake(temperatureTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
-        // draw temperature text from GY21Sensor
-        drawTextToPanel(textBufferTemperature, temperatureTextX + temperatureTextXOffset,
-                        temperatureTextY + temperatureTextYOffset, temperatureFont, temperatureFontColor);
+        temperatureLayer.setMask(temperatureMask, temperatureFontColor);
         xSemaphoreGive(temperatureTextMutex);
     }
     else
     {
         Logger::println("WARNING: drawTemperatureText timeout");
     }
-    // draw humidity text from GY21Sensor
+    // humidity text from GY21Sensor
     if (xSemaphoreTake(humidityTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
-
-        drawTextToPanel(textBufferHumidity, humidityTextX + humidityTextXOffset,
-                        humidityTextY + humidityTextYOffset, humidityFont, humidityFontColor);
+        humidityLayer.setMask(humidityMask, humidityFontColor);
         xSemaphoreGive(humidityTextMutex);
     }
     else
@@ -389,25 +570,38 @@ void MatrixDriver::drawAllTextToPanel()
     }
 }
 
-// draw text to panel at (x,y) with given font and color
-void MatrixDriver::drawTextToPanel(char *text, int8_t x, int8_t y, const GFXfont *font, uint16_t fontColor)
+// rasterise the temperature text as the panel would print it. temperatureTextMutex must be held
+void MatrixDriver::renderTemperatureMask()
+{
+    temperatureMask.render(textBufferTemperature, temperatureAtlas,
+                           temperatureTextX + temperatureTextXOffset, temperatureTextY + temperatureTextYOffset);
+}
+
+// rasterise the humidity text as the panel would print it. humidityTextMutex must be held
+void MatrixDriver::renderHumidityMask()
 {
-    panel->setFont(font);
-    panel->printText(text, x, y, fontColor);
+    humidityMask.render(textBufferHumidity, humidityAtlas,
+                        humidityTextX + humidityTextXOffset, humidityTextY + humidityTextYOffset);
 }
 
 void MatrixDriver::setTemperatureText(const char *text)
 {
     if (xSemaphoreTake(temperatureTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
-        strncpy(textBufferTemperature, text, sizeof(textBufferTemperature) - 1);
-        textBufferTemperature[sizeof(textBufferTemperature) - 1] = '\0';
+        // the sensor sends the same text again often, only rasterise changes
+        if (strncmp(textBufferTemperature, text, sizeof(textBufferTemperature) - 1) != 0)
+        {
+            strncpy(textBufferTemperature, text, sizeof(textBufferTemperature) - 1);
+            textBufferTemperature[sizeof(textBufferTemperature) - 1] = '\0';
+            renderTemperatureMask();
+        }
         xSemaphoreGive(temperatureTextMutex);
     }
     else
     {
         Logger::println("WARNING: setText timeout");
     }
+    wakeUpdateTask();
 }
 
 void MatrixDriver::setTemperatureTextPosition(uint8_t x, uint8_t y)
@@ -416,8 +610,10 @@ void MatrixDriver::setTemperatureTextPosition(uint8_t x, uint8_t y)
     {
         temperatureTextX = x;
         temperatureTextY = y;
+        renderTemperatureMask();
         xSemaphoreGive(temperatureTextMutex);
     }
+    wakeUpdateTask();
 }
 
 void MatrixDriver::setTemperatureTextXOffset(int8_t xOffset)
@@ -425,8 +621,10 @@ void MatrixDriver::setTemperatureTextXOffset(int8_t xOffset)
     if (xSemaphoreTake(temperatureTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
         temperatureTextXOffset = xOffset;
+        renderTemperatureMask();
         xSemaphoreGive(temperatureTextMutex);
     }
+    wakeUpdateTask();
 }
 
 void MatrixDriver::setTemperatureTextYOffset(int8_t yOffset)
@@ -434,8 +632,10 @@ void MatrixDriver::setTemperatureTextYOffset(int8_t yOffset)
     if (xSemaphoreTake(temperatureTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
         temperatureTextYOffset = yOffset;
+        renderTemperatureMask();
         xSemaphoreGive(temperatureTextMutex);
     }
+    wakeUpdateTask();
 }
 // set font for text drawing
 void MatrixDriver::setTemperatureFont(const GFXfont *font)
@@ -443,21 +643,27 @@ void MatrixDriver::setTemperatureFont(const GFXfont *font)
     if (xSemaphoreTake(temperatureTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
         this->temperatureFont = font;
-        // also update text size calculations
-        panel->setFont(this->temperatureFont);
+        // decode the glyphs the text uses, and measure from them
+        temperatureAtlas.build(font, SENSOR_TEXT_GLYPHS);
         // centre middle
-        temperatureTextX = (MATRIX_WIDTH - panel->getTextWidth(String(maxTemperatureTextString))) / 2;
-        temperatureTextY = (MATRIX_HEIGHT + panel->getTextHeight(String(maxTemperatureTextString))) / 2;
+        temperatureTextX = (MATRIX_WIDTH - temperatureAtlas.getTextWidth(maxTemperatureTextString)) / 2;
+        temperatureTextY = (MATRIX_HEIGHT + temperatureAtlas.getTextHeight(maxTemperatureTextString)) / 2;
+        renderTemperatureMask();
         xSemaphoreGive(temperatureTextMutex);
     }
+    wakeUpdateTask();
 }
 
 void MatrixDriver::setTemperatureFontColor(uint16_t color)
 {
     if (xSemaphoreTake(temperatureTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
+        // this is set again every loop in some modes, only wake the update task on a change
+        bool changed = (this->temperatureFontColor != color);
         this->temperatureFontColor = color;
         xSemaphoreGive(temperatureTextMutex);
+        if (changed)
+            wakeUpdateTask();
     }
 }
 
@@ -465,14 +671,20 @@ void MatrixDriver::setHumidityText(const char *text)
 {
     if (xSemaphoreTake(humidityTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
-        strncpy(textBufferHumidity, text, sizeof(textBufferHumidity) - 1);
-        textBufferHumidity[sizeof(textBufferHumidity) - 1] = '\0';
+        // the sensor sends the same text again often, only rasterise changes
+        if (strncmp(textBufferHumidity, text, sizeof(textBufferHumidity) - 1) != 0)
+        {
+            strncpy(textBufferHumidity, text, sizeof(textBufferHumidity) - 1);
+            textBufferHumidity[sizeof(textBufferHumidity) - 1] = '\0';
+            renderHumidityMask();
+        }
         xSemaphoreGive(humidityTextMutex);
     }
     else
     {
         Logger::println("WARNING: setHumidityText timeout");
     }
+    wakeUpdateTask();
 }
 
 void MatrixDriver::setHumidityTextPosition(uint8_t x, uint8_t y)
@@ -481,8 +693,10 @@ void MatrixDriver::setHumidityTextPosition(uint8_t x, uint8_t y)
     {
         humidityTextX = x;
         humidityTextY = y;
+        renderHumidityMask();
         xSemaphoreGive(humidityTextMutex);
     }
+    wakeUpdateTask();
 }
 
 void MatrixDriver::setHumidityTextXOffset(int8_t xOffset)
@@ -490,8 +704,10 @@ void MatrixDriver::setHumidityTextXOffset(int8_t xOffset)
     if (xSemaphoreTake(humidityTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
         humidityTextXOffset = xOffset;
+        renderHumidityMask();
         xSemaphoreGive(humidityTextMutex);
     }
+    wakeUpdateTask();
 }
 
 void MatrixDriver::setHumidityTextYOffset(int8_t yOffset)
@@ -499,8 +715,10 @@ void MatrixDriver::setHumidityTextYOffset(int8_t yOffset)
     if (xSemaphoreTake(humidityTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
         humidityTextYOffset = yOffset;
+        renderHumidityMask();
         xSemaphoreGive(humidityTextMutex);
     }
+    wakeUpdateTask();
 }
 // set font for text drawing
 void MatrixDriver::setHumidityFont(const GFXfont *font)
@@ -508,29 +726,37 @@ void MatrixDriver::setHumidityFont(const GFXfont *font)
     if (xSemaphoreTake(humidityTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
         this->humidityFont = font;
-        // also update text size calculations
-        panel->setFont(this->humidityFont);
+        // decode the glyphs the text uses, and measure from them
+        humidityAtlas.build(font, SENSOR_TEXT_GLYPHS);
         // centre bottom
-        humidityTextX = (MATRIX_WIDTH - panel->getTextWidth(String(maxHumidityTextString))) / 2;
-        humidityTextY = MATRIX_HEIGHT - panel->getTextHeight(String(maxHumidityTextString));
-        Logger::printf("Humidity font set. Text width: %d, height: %d\n",
-                       panel->getTextWidth(String(maxHumidityTextString)),
-                       panel->getTextHeight(String(maxHumidityTextString)));
+        humidityTextX = (MATRIX_WIDTH - humidityAtlas.getTextWidth(maxHumidityTextString)) / 2;
+        humidityTextY = MATRIX_HEIGHT - humidityAtlas.getTextHeight(maxHumidityTextString);
+        Logger::printf("Humidity font set. Text width: %d, height: %d, glyph atlas: %d bytes\n",
+                       humidityAtlas.getTextWidth(maxHumidityTextString),
+                       humidityAtlas.getTextHeight(maxHumidityTextString),
+                       humidityAtlas.getUsedBytes());
+        renderHumidityMask();
         xSemaphoreGive(humidityTextMutex);
     }
+    wakeUpdateTask();
 }
 
 void MatrixDriver::setHumidityFontColor(uint16_t color)
 {
     if (xSemaphoreTake(humidityTextMutex, pdMS_TO_TICKS(100)) == pdTRUE)
     {
+        // this is set again every loop in some modes, only wake the update task on a change
+        bool changed = (this->humidityFontColor != color);
         this->humidityFontColor = color;
         xSemaphoreGive(humidityTextMutex);
+        if (changed)
+            wakeUpdateTask();
     }
 }
 
 MatrixDriver::~MatrixDriver()
 {
+    delete jobSystem;
     if (matrixMutex != NULL)
     {
         vSemaphoreDelete(matrixMutex);
@@ -10,14 +10,48 @@
 
 #include "Panel.h"
 #include "Matrix.h"
+#include "FrameQueue.h"
+#include "TextMask.h"
+#include "GlyphAtlas.h"
+#include "Compositor.h"
+#include "TimeHistogram.h"
+#include "JobSystem.h"
 #include "GY21Sensor.h"
 #include "Logger.h"
+#include "Trace.h"
 #include "MODES.h"
 
 #define MAX_FPS 120
+#define SENSOR_TEXT_GLYPHS " -.0123456789*/" // every character the sensor texts use
+#define FRAME_PRODUCER_CORE 0 // matrix states are calculated ahead on the core not running the display
+#define FRAME_JOB_WORKERS 1   // job workers helping the producer split a frame, from the display core on
+#define IDLE_WAKE_MS 1000     // longest the update task sleeps waiting for a change with no background
+#define FRAME_STATS_LOG_FRAMES 600 // frames between frame time logs
+
+// stages of a display frame, timed into a histogram each
+enum FrameStage
+{
+    STAGE_SWAP,    // showing the last frame drawn
+    STAGE_WAIT,    // waiting for the frame boundary, or for a change
+    STAGE_READ,    // brightness and sensor text
+    STAGE_FETCH,   // taking the next frame from the producer
+    STAGE_COMPOSE, // composing the layers
+    STAGE_DRAW,    // writing the composed rows to the panel
+    STAGE_WORK,    // read to draw, all the work of the frame
+    STAGE_COUNT
+};
 
 // class to manage the matrix display updates in a background task
-// at a specified frames-per-second rate
+// at a specified frames-per-second rate.
+// A producer task on the other core calculates the matrix frames ahead into a FrameQueue,
+// so the display task only has to draw the next finished frame, add text and swap.
+// Matrices that split their frames into jobs share them between the producer and a job
+// worker on the display core, which runs between display updates.
+// Texts are rasterised into masks when they change, so each frame only draws their pixels.
+// The display task composes the matrix frame and the texts as layers into one frame,
+// which is written to the panel in one pass.
+// Only the rows some layer changed are composed and written. When nothing changed the frame
+// isn't drawn or swapped at all, and with no background the task sleeps until a change.
 class MatrixDriver
 {
 public:
@@ -63,6 +97,14 @@ public:
         return matrixCurrent->getCycling();
     }
 
+    // frame timing. snapshots can be taken from any task while frames are drawn
+    void getStageSnapshot(FrameStage stage, HistogramSnapshot &snapshot) const { stageTimes[stage].snapshot(snapshot); }
+    static const char *getStageName(FrameStage stage);
+    // frames that started after their frame boundary, as the last overran the effective period
+    uint32_t getDeadlineMisses() const { return deadlineMisses.load(); }
+    // log every stage's percentiles, the current matrix's calculation time and counters, and the frame counters
+    void logFrameStats();
+
     // Text related functions
     void setTemperatureText(const char *text);
     void setTemperatureTextPosition(uint8_t x, uint8_t y);
@@ -97,13 +139,37 @@ private:
 
     // This TaskHandle for the update function
     TaskHandle_t updateTaskHandle = NULL;
-
-    // draw the cells in matrix to the panel, one by one
-    void drawCellsToPanel(Matrix *matrix);
-    // draw text to the panel at (x,y) with given font and color
-    void drawTextToPanel(char *text, int8_t x, int8_t y, const GFXfont *font, uint16_t fontColor);
-    // draw all texts to the panel
-    void drawAllTextToPanel();
+    // This TaskHandle for the frame producer function
+    TaskHandle_t producerTaskHandle = NULL;
+
+    // frames calculated ahead by the producer task
+    FrameQueue frameQueue;
+    uint32_t frameGeneration = 0;                // bumped when queued frames go stale. protected by matrixMutex
+    JobSystem *jobSystem = nullptr;              // workers that help the producer calculate a frame
+
+    // frame timing, recorded by the update task
+    TimeHistogram stageTimes[STAGE_COUNT];
+    std::atomic<uint32_t> framesTimed;
+    std::atomic<uint32_t> deadlineMisses;
+
+    // layers of the displayed frame, bottom first. only used by the update task
+    Compositor compositor;
+    FrameLayer backgroundLayer{"Background"};
+    MaskLayer temperatureLayer{"Temperature"};
+    MaskLayer humidityLayer{"Humidity"};
+    FrameBuffer composedFrame;
+    uint32_t framesSuppressed = 0; // frames with nothing changed, so not drawn. update task only
+    uint32_t rowsWritten = 0;      // rows written to the panel. update task only
+
+    // wake the update task if it's waiting for a change
+    void wakeUpdateTask();
+
+    // give the text layers the current text masks and colours
+    void updateTextLayers();
+    // rasterise the texts into their masks. call with the text's mutex held,
+    // whenever its text, font or position changes
+    void renderTemperatureMask();
+    void renderHumidityMask();
 
     // the main update task function that updates the matrix display
     void updateTask();
@@ -114,10 +180,21 @@ private:
         static_cast<MatrixDriver *>(params)->updateTask();
     }
 
+    // the producer task function that calculates matrix frames ahead into the frame queue
+    void producerTask();
+
+    // a static function wrapper we can use as a task function
+    static void producerTaskWrapper(void *params)
+    {
+        static_cast<MatrixDriver *>(params)->producerTask();
+    }
+
     ///////////////////////
     // Text related members
     SemaphoreHandle_t temperatureTextMutex; // Protects all Temperature text-related members
-    char textBufferTemperature[16];
+    char textBufferTemperature[16] = "";
+    TextMask temperatureMask; // the text as drawn, rasterised when it changes
+    FixedGlyphAtlas<GlyphAtlas::charsetSize(SENSOR_TEXT_GLYPHS)> temperatureAtlas; // the font's glyphs, decoded when set
     // for text size calculations. note we change font glyph * to °, for GFXFonts without degree symbol
     const char *maxTemperatureTextString = "99.9*";
     const GFXfont *temperatureFont;
@@ -129,7 +206,9 @@ private:
     int8_t temperatureTextYOffset = 0; // for visual centering adjustments
 
     SemaphoreHandle_t humidityTextMutex; // Protects all Humidity text-related members
-    char textBufferHumidity[16];
+    char textBufferHumidity[16] = "";
+    TextMask humidityMask; // the text as drawn, rasterised when it changes
+    FixedGlyphAtlas<GlyphAtlas::charsetSize(SENSOR_TEXT_GLYPHS)> humidityAtlas; // the font's glyphs, decoded when set
     // for text size calculations. we changed percent symbol % to / for smaller font file
     const char *maxHumidityTextString = "55/";
     const GFXfont *humidityFont;
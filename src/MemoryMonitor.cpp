@@ -0,0 +1,98 @@
+#include "MemoryMonitor.h"
+
+SubsystemMemory MemoryMonitor::subsystems[MEMORY_MONITOR_MAX_SUBSYSTEMS];
+int MemoryMonitor::subsystemCount = 0;
+uint32_t MemoryMonitor::lastInternalUsed = 0;
+uint32_t MemoryMonitor::lastPsramUsed = 0;
+
+void MemoryMonitor::begin()
+{
+    subsystemCount = 0;
+    lastInternalUsed = usedBytes(MALLOC_CAP_INTERNAL);
+    lastPsramUsed = usedBytes(MALLOC_CAP_SPIRAM);
+}
+
+uint32_t MemoryMonitor::usedBytes(uint32_t caps)
+{
+    return heap_caps_get_total_size(caps) - heap_caps_get_free_size(caps);
+}
+
+void MemoryMonitor::checkpoint(const char *subsystem)
+{
+    uint32_t internalUsed = usedBytes(MALLOC_CAP_INTERNAL);
+    uint32_t psramUsed = usedBytes(MALLOC_CAP_SPIRAM);
+    SubsystemMemory memory = {subsystem, (int32_t)(internalUsed - lastInternalUsed), (int32_t)(psramUsed - lastPsramUsed)};
+    lastInternalUsed = internalUsed;
+    lastPsramUsed = psramUsed;
+
+    if (subsystemCount < MEMORY_MONITOR_MAX_SUBSYSTEMS)
+    {
+        subsystems[subsystemCount++] = memory;
+    }
+    Logger::printf("Memory - %s: internal %ld, PSRAM %ld bytes\n", subsystem,
+                   (long)memory.internalBytes, (long)memory.psramBytes);
+}
+
+void MemoryMonitor::getHeapStats(uint32_t caps, HeapStats &stats)
+{
+    stats.total = heap_caps_get_total_size(caps);
+    stats.free = heap_caps_get_free_size(caps);
+    stats.minimumFree = heap_caps_get_minimum_free_size(caps);
+    stats.largestBlock = heap_caps_get_largest_free_block(caps);
+    stats.fragmentation = (stats.free > 0) ? 100 - (uint8_t)((uint64_t)stats.largestBlock * 100 / stats.free) : 0;
+}
+
+void MemoryMonitor::logHeap(const char *name, uint32_t caps)
+{
+    HeapStats stats;
+    getHeapStats(caps, stats);
+    if (stats.total == 0)
+    {
+        Logger::printf("  %-8s none\n", name);
+        return;
+    }
+    Logger::printf("  %-8s total %lu, free %lu, lowest free %lu, largest block %lu, fragmentation %u%%\n", name,
+                   (unsigned long)stats.total, (unsigned long)stats.free, (unsigned long)stats.minimumFree,
+                   (unsigned long)stats.largestBlock, stats.fragmentation);
+}
+
+// the least stack each task has had free, the most it could shrink by
+void MemoryMonitor::logTaskStacks()
+{
+#if configUSE_TRACE_FACILITY
+    static TaskStatus_t taskStatus[MEMORY_MONITOR_MAX_TASKS]; // too big for the stack. one task only
+    UBaseType_t count = uxTaskGetSystemState(taskStatus, MEMORY_MONITOR_MAX_TASKS, NULL);
+    if (count == 0)
+    {
+        Logger::printf("  more than %d tasks, stacks not listed\n", MEMORY_MONITOR_MAX_TASKS);
+        return;
+    }
+    Logger::print("  Stack high-water marks (bytes never used):\n");
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        // esp-idf stacks are counted in bytes
+        Logger::printf("    %-16s %u\n", taskStatus[i].pcTaskName, (unsigned)taskStatus[i].usStackHighWaterMark);
+    }
+#else
+    // just this task without the task list
+    Logger::printf("  Stack high-water mark of %s: %u bytes\n", pcTaskGetName(NULL),
+                   (unsigned)uxTaskGetStackHighWaterMark(NULL));
+#endif
+}
+
+void MemoryMonitor::logSnapshot(const char *label)
+{
+    Logger::printf("Memory snapshot - %s\n", label);
+    logHeap("Internal", MALLOC_CAP_INTERNAL);
+    logHeap("PSRAM", MALLOC_CAP_SPIRAM);
+    logTaskStacks();
+    if (subsystemCount > 0)
+    {
+        Logger::print("  Subsystems (internal/PSRAM bytes at creation):\n");
+        for (int i = 0; i < subsystemCount; i++)
+        {
+            Logger::printf("    %-16s %ld/%ld\n", subsystems[i].name,
+                           (long)subsystems[i].internalBytes, (long)subsystems[i].psramBytes);
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef MEMORYMONITOR_H
+#define MEMORYMONITOR_H
+
+#pragma once
+
+#include <Arduino.h>
+#include "esp_heap_caps.h"
+#include "Logger.h"
+
+#define MEMORY_MONITOR_MAX_SUBSYSTEMS 16 // checkpoints kept, later ones are only logged
+#define MEMORY_MONITOR_MAX_TASKS 32      // tasks whose stacks are reported
+
+// one heap, internal SRAM or PSRAM, in bytes
+struct HeapStats
+{
+    uint32_t total;
+    uint32_t free;
+    uint32_t minimumFree;  // lowest free has been since boot
+    uint32_t largestBlock; // largest single allocation that would succeed
+    uint8_t fragmentation; // % of the free memory not in the largest block
+};
+
+// heap taken by one subsystem, between its checkpoint and the one before
+struct SubsystemMemory
+{
+    const char *name;
+    int32_t internalBytes;
+    int32_t psramBytes;
+};
+
+// Memory instrumentation for sizing task stacks and deciding what can move to PSRAM.
+// checkpoint() after creating each subsystem charges it with the heap used since the
+// last checkpoint, split into internal SRAM and PSRAM. Other tasks (e.g. WiFi) allocating
+// meanwhile are charged too, so take them while little else is running, e.g. in setup().
+// logSnapshot() logs both heaps (free, lowest free, largest block, fragmentation), every
+// task's stack high-water mark, and the subsystems checkpointed so far.
+// Call from one task only, e.g. setup() and loop().
+// Usage:
+//     MemoryMonitor::begin();                  // first thing in setup()
+//     panel = new Panel(...);
+//     MemoryMonitor::checkpoint("Panel");      // heap used since begin() is the Panel's
+//     MemoryMonitor::logSnapshot("Boot");      // at the end of setup and after a mode switch
+class MemoryMonitor
+{
+public:
+    // start counting from the heaps as they are now
+    static void begin();
+    // charge the heap used since the last checkpoint (or begin()) to subsystem, and log it.
+    // name must be a string literal
+    static void checkpoint(const char *subsystem);
+    // log heaps, task stacks and subsystems, under label
+    static void logSnapshot(const char *label);
+
+    // the subsystems checkpointed since begin(), in order
+    static int getSubsystemCount() { return subsystemCount; }
+    static const SubsystemMemory &getSubsystem(int index) { return subsystems[index]; }
+
+    // stats of the heap with the given capabilities e.g. MALLOC_CAP_INTERNAL, MALLOC_CAP_SPIRAM
+    static void getHeapStats(uint32_t caps, HeapStats &stats);
+
+private:
+    static SubsystemMemory subsystems[MEMORY_MONITOR_MAX_SUBSYSTEMS];
+    static int subsystemCount;
+    // used bytes of each heap at the last checkpoint
+    static uint32_t lastInternalUsed;
+    static uint32_t lastPsramUsed;
+
+    static uint32_t usedBytes(uint32_t caps);
+    static void logHeap(const char *name, uint32_t caps);
+    static void logTaskStacks();
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include <WiFi.h>
 #include <ESPmDNS.h>
 #include "Logger.h"
+#include "Trace.h"
 
 // simple class to handle OTA updates and WiFi reconnection
 // - On Windows, Bonjour service must be installed and running for mDNS resolution.
@@ -40,6 +41,7 @@ public:
     // call once per main loop iteration to handle OTA and reconnect if needed
     void handle()
     {
+        TRACE_ZONE("OTA");
         ArduinoOTA.handle();
         reconnectIfNeeded();
     }
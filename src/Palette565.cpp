@@ -0,0 +1,50 @@
+#include "Palette565.h"
+
+// rebuild the table if the palette or brightness changed, and take the next step of any morph
+bool Palette565::update(int paletteId, const CRGBPalette16 &palette, uint8_t brightness, int transitionFrames)
+{
+    bool paletteChanged = (paletteId != this->paletteId);
+    if (!paletteChanged && brightness == this->brightness && !isMorphing())
+        return false;
+
+    if (paletteChanged || brightness != this->brightness)
+    {
+        // morph to a new palette from whatever is showing now, even part way through a morph
+        if (paletteChanged && this->paletteId >= 0 && transitionFrames > 0)
+        {
+            memcpy(morphColors, colors, sizeof(colors));
+            morphFrame = 0;
+            morphFrames = transitionFrames;
+        }
+        else if (paletteChanged)
+        {
+            morphFrame = morphFrames = 0;
+        }
+        expand(palette, brightness);
+        this->paletteId = paletteId;
+        this->brightness = brightness;
+    }
+
+    if (isMorphing())
+    {
+        morphFrame++;
+        uint16_t weight = (uint16_t)((morphFrame * 256) / morphFrames); // reaches 256, all target, on the last frame
+        ColorMath::blendRow565(colors, morphColors, targetColors, SIZE, weight);
+    }
+    else
+    {
+        memcpy(colors, targetColors, sizeof(colors));
+    }
+    return true;
+}
+
+// expand the palette into the target table
+void Palette565::expand(const CRGBPalette16 &palette, uint8_t brightness)
+{
+    for (int index = 0; index < SIZE; index++)
+    {
+        CRGB color = ColorFromPalette(palette, index, brightness, LINEARBLEND);
+        targetColors[index] = Matrix::rgbTo565(color.r, color.g, color.b);
+    }
+    rebuildCount++;
+}
@@ -0,0 +1,61 @@
+#ifndef PALETTE565_H
+#define PALETTE565_H
+
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "Matrix.h"
+#include "ColorMath.h"
+
+// A FastLED CRGBPalette16 expanded to 256 RGB565 colours at one brightness.
+// Looking up a colour is then a single table load, instead of interpolating the palette,
+// scaling by the brightness and packing to 565 for every pixel. The entries are exactly
+// rgbTo565(ColorFromPalette(palette, index, brightness)).
+// The table is only rebuilt when the palette or the brightness it was built for changes.
+// A palette change can also morph from the old colours to the new ones over a number of
+// frames. The morph blends the 256 table entries once a frame, so it costs the same
+// however many pixels use the table.
+// Usage:
+//     Palette565 paletteColors;
+//     // each frame, cheap if unchanged. a new paletteId morphs to it over 60 frames
+//     paletteColors.update(paletteIndex, palettes[paletteIndex], brightness, 60);
+//     row[x] = paletteColors[colorIndex];
+class Palette565
+{
+public:
+    static const int SIZE = 256;
+
+    // call once per frame. rebuilds the table if paletteId or brightness differ from those it
+    // was built for. paletteId is any number identifying the palette e.g. its index in a list.
+    // a new paletteId is morphed to over transitionFrames calls (0 = switch at once).
+    // returns true if the table changed
+    bool update(int paletteId, const CRGBPalette16 &palette, uint8_t brightness, int transitionFrames = 0);
+
+    // force a rebuild on the next update() e.g. after the palette's colours were changed
+    void invalidate() { paletteId = -1; }
+
+    // whether a morph to a new palette is under way
+    bool isMorphing() const { return morphFrame < morphFrames; }
+
+    uint16_t operator[](uint8_t index) const { return colors[index]; }
+    const uint16_t *data() const { return colors; }
+
+    // times the table has been built, for logging
+    uint32_t getRebuildCount() const { return rebuildCount; }
+
+private:
+    alignas(4) uint16_t colors[SIZE];       // the colours in use
+    alignas(4) uint16_t targetColors[SIZE]; // the palette at the brightness, what colors morphs to
+    alignas(4) uint16_t morphColors[SIZE];  // the colours when the morph started
+    int paletteId = -1;                     // palette the table was built for, -1 if none
+    uint8_t brightness = 0;
+    int morphFrame = 0;  // frames of the morph done
+    int morphFrames = 0; // length of the morph
+    uint32_t rebuildCount = 0;
+
+    // expand the palette at the brightness into targetColors
+    void expand(const CRGBPalette16 &palette, uint8_t brightness);
+};
+
+#endif
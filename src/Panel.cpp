@@ -83,14 +83,18 @@ void Panel::drawPixel(int16_t x, int16_t y, uint16_t color)
     matPanel->drawPixel(x, y, color);
 }
 
-// write a full buffer to the panel with 565 color
-void Panel::writeBuffer(uint16_t buffer[64][32])
+// write only the rows of the buffer with their bit set in rows (bit y = row y)
+void Panel::writeRows(const FrameBuffer &frame, uint32_t rows)
 {
-    for (int x = 0; x < 64; x++)
+    TRACE_ZONE("Draw");
+    for (int y = 0; y < MAT_HEIGHT; y++)
     {
-        for (int y = 0; y < 32; y++)
+        if (!(rows & ((uint32_t)1 << y)))
+            continue;
+        const uint16_t *row = frame.row(y);
+        for (int x = 0; x < MAT_WIDTH; x++)
         {
-            matPanel->drawPixel(x, y, buffer[x][y]);
+            matPanel->drawPixel(x, y, row[x]);
         }
     }
 }
@@ -107,24 +111,6 @@ void Panel::printText(char *text, int8_t x, int8_t y, uint16_t color)
    // Logger::printf("Printing text '%s' at (%d,%d) with color 0x%04X\n", text, x, y, color);
 }
 
-// return the width in pixels of the given text string, with the current font
-int Panel::getTextWidth(String textString)
-{
-    int16_t x1, y1;
-    uint16_t textWidth, textHeight;
-    matPanel->getTextBounds(textString, 0, 0, &x1, &y1, &textWidth, &textHeight);
-    return textWidth;
-}
-
-// return the height in pixels of the given text string, with the current font
-int Panel::getTextHeight(String textString)
-{
-    int16_t x1, y1;
-    uint16_t textWidth, textHeight;
-    matPanel->getTextBounds(textString, 0, 0, &x1, &y1, &textWidth, &textHeight);
-    return textHeight;
-}
-
 // set font for text drawing
 void Panel::setFont(const GFXfont *font)
 {
@@ -140,6 +126,7 @@ void Panel::setFontColor(uint16_t color)
 // for double buffering, swap the DMA buffers
 void Panel::swapDMABuffers()
 {
+    TRACE_ZONE("Swap");
     matPanel->flipDMABuffer();
 }
 
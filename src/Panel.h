@@ -6,6 +6,8 @@
 #include <Adafruit_NeoPixel.h>
 #include <ESP32-HUB75-MatrixPanel-I2S-DMA.h>
 #include "Logger.h"
+#include "Trace.h"
+#include "FrameBuffer.h"
 
 #include <Fonts/FreeMono9pt7b.h>
 
@@ -46,8 +48,8 @@ public:
     // draw a pixel to the panel at (x,y) with 565 color
     void drawPixel(int16_t x, int16_t y, uint16_t color);
 
-    // write a full buffer to the panel with 565 color
-    void writeBuffer(uint16_t buffer[MAT_WIDTH][MAT_HEIGHT]);
+    // write only the rows of the buffer with their bit set in rows (bit y = row y)
+    void writeRows(const FrameBuffer &frame, uint32_t rows);
 
     // set font for text drawing
     void setFont(const GFXfont *font);
@@ -56,8 +58,6 @@ public:
 
     // print text to panel at (x,y) with 565 color
     void printText(char *text, int8_t x, int8_t y, uint16_t color);
-    int getTextWidth(String textString);
-    int getTextHeight(String textString);
 
     // for double buffering, swap the DMA buffers
     void swapDMABuffers();
@@ -1,6 +1,6 @@
 #include "PlasmaMatrix.h"
 
-PlasmaMatrix::PlasmaMatrix()
+PlasmaMatrix::PlasmaMatrix() : Matrix(FRAME_FORMAT_INDEXED8)
 {
     this->backgroundModeRelativeBrightness = BACKGROUND_MODE_RELATIVE_BRIGHTNESS_PLASMA;
     this->foregroundModeRelativeBrightness = FOREGROUND_MODE_RELATIVE_BRIGHTNESS_PLASMA;
@@ -8,7 +8,9 @@ PlasmaMatrix::PlasmaMatrix()
     this->backgroundMode.store(true);
     this->currentRelativeBrightness.store(this->backgroundModeRelativeBrightness);
     this->currentPaletteIndex.store(0);
-    this->currentPalette = palettes[0];
+    this->paletteTransitionFrames.store(PLASMA_PALETTE_TRANSITION_FRAMES);
+    // frames hold palette indices, coloured from the palette table when written out
+    this->framePalette = paletteColors.data();
 
     initialise();
 }
@@ -18,30 +20,34 @@ void PlasmaMatrix::initialise()
 {
     // how bright the plasma appears when text on display (0-1.0f)
     backgroundModeRelativeBrightness = 0.4f;
-
-    // Set current FastLED palette
-    currentPalette = RainbowColors_p;
 }
 
 void PlasmaMatrix::calcNewStates()
 {
-    currentPalette = palettes[currentPaletteIndex.load()];
+    // the palette as 565 colours at this brightness, rebuilt only when either has changed
+    // e.g. on nextPalette(), setBackgroundMode() or a palette change while cycling.
+    // a new palette is morphed to over a number of frames, a step of 256 colours a frame.
+    // frames are palette indices, so this is all a palette or brightness change costs
+    int paletteIndex = currentPaletteIndex.load();
     uint8_t scaledBrightness = static_cast<uint8_t>(currentRelativeBrightness.load() * 255);
+    paletteColors.update(paletteIndex, palettes[paletteIndex], scaledBrightness, paletteTransitionFrames.load());
 
+    // the plasma is the sum of a wave along x, a wave along y and a wave of x*y.
+    // the first two only depend on one coordinate, so are calculated once per frame here
+    uint8_t wibble = sin8(time_counter);
     for (int x = 0; x < MATRIX_ARRAY_WIDTH; x++)
     {
-        for (int y = 0; y < MATRIX_ARRAY_HEIGHT; y++)
-        {
-            int16_t v = 128;
-            uint8_t wibble = sin8(time_counter);
-            v += sin16(x * wibble * 3 + time_counter);
-            v += cos16(y * (128 - wibble) + time_counter);
-            v += sin16(y * x * cos8(-time_counter) / 8);
-
-            currentColor = ColorFromPalette(currentPalette, (v >> 8), scaledBrightness);
-            bufferPrimary[x][y] = rgbTo565(currentColor.r, currentColor.g, currentColor.b);
-        }
+        columnWave[x] = sin16(x * wibble * 3 + time_counter);
+    }
+    for (int y = 0; y < MATRIX_ARRAY_HEIGHT; y++)
+    {
+        rowWave[y] = cos16(y * (128 - wibble) + time_counter);
     }
+    productScale = cos8(-time_counter);
+
+    // rows are independent, so calculate them in bands spread across the job system if set
+    runJobs(PLASMA_ROW_BANDS, PlasmaMatrix::rowBandJob, this);
+
     ++time_counter;
 
     // cycle through palettes every 1024 frames if cycling is enabled
@@ -52,7 +58,32 @@ void PlasmaMatrix::calcNewStates()
         {
             time_counter = 0;
             cycles = 0;
-            currentPaletteIndex.store(random(0, sizeof(palettes) / sizeof(palettes[0])));
+            currentPaletteIndex.store(rng.nextBelow(sizeof(palettes) / sizeof(palettes[0])));
+        }
+    }
+}
+
+// calculate the palette indices of one band of rows from this frame's waves.
+// only writes the band's rows, so bands can run at the same time
+void PlasmaMatrix::calcRowBand(int band)
+{
+    const int rowsPerBand = MATRIX_ARRAY_HEIGHT / PLASMA_ROW_BANDS;
+    for (int y = band * rowsPerBand; y < (band + 1) * rowsPerBand; y++)
+    {
+        uint8_t *row = indexPrimary->row(y);
+        int rowValue = 128 + rowWave[y];
+
+        // the x*y wave's angle is (x * y * productScale) / 8. the product is accumulated
+        // along the row instead of multiplied out per pixel
+        uint32_t productStep = y * productScale;
+        uint32_t product = 0;
+        for (int x = 0; x < MATRIX_ARRAY_WIDTH; x++)
+        {
+            // summed as int and wrapped to 16 bits once, the same as adding into an int16_t term by term
+            int16_t v = rowValue + columnWave[x] + sin16(product >> 3);
+            product += productStep;
+
+            row[x] = (uint8_t)(v >> 8); // top byte of the plasma is the palette index
         }
     }
 }
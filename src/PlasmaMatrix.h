@@ -5,9 +5,12 @@
 
 #include <FastLED.h>
 #include "Matrix.h"
+#include "Palette565.h"
 
 #define BACKGROUND_MODE_RELATIVE_BRIGHTNESS_PLASMA 0.6f
 #define FOREGROUND_MODE_RELATIVE_BRIGHTNESS_PLASMA 1.0f
+#define PLASMA_ROW_BANDS 8                  // jobs per frame, see calcRowBand()
+#define PLASMA_PALETTE_TRANSITION_FRAMES 60 // frames to morph between palettes
 
 class PlasmaMatrix : public Matrix
 {
@@ -17,30 +20,43 @@ public:
 
     void initialise() override;
     void calcNewStates() override;
+    const char *getName() const override { return "PlasmaMatrix"; }
 
     // move to next pallette in list
     void nextPalette() override
     {
         int index = currentPaletteIndex.load();
         index = (index + 1) % (sizeof(palettes) / sizeof(palettes[0]));
-        currentPalette = palettes[index];
         currentPaletteIndex.store(index);
         Logger::printf("Switched to palette index %d\n", index);
     }
 
+    void setPaletteTransitionFrames(int frames) override
+    {
+        paletteTransitionFrames.store(frames);
+    }
+
 private:
-    CRGB currentColor;
     CRGBPalette16 palettes[8] = {HeatColors_p, LavaColors_p, ForestColors_p, CloudColors_p, OceanColors_p,
                                  PartyColors_p, RainbowColors_p, RainbowStripeColors_p};
-    CRGBPalette16 currentPalette;
+    Palette565 paletteColors; // current palette as 565 colours at the current brightness
     std::atomic<int> currentPaletteIndex;
+    std::atomic<int> paletteTransitionFrames;
 
     uint16_t time_counter = 0;
     uint16_t cycles = 0;
 
-    CRGB ColorFromCurrentPalette(uint8_t index = 0, uint8_t brightness = 255, TBlendType blendType = LINEARBLEND)
+    // this frame's waves along x and along y, and the scale of the x*y wave
+    int16_t columnWave[MATRIX_ARRAY_WIDTH];
+    int16_t rowWave[MATRIX_ARRAY_HEIGHT];
+    uint8_t productScale = 0;
+
+    // calculate the palette indices of one band of rows
+    void calcRowBand(int band);
+    // a static function wrapper we can use as a job function
+    static void rowBandJob(void *context, int band)
     {
-        return ColorFromPalette(currentPalette, index, brightness, blendType);
+        static_cast<PlasmaMatrix *>(context)->calcRowBand(band);
     }
 };
 
@@ -0,0 +1,85 @@
+#include "TextMask.h"
+
+const int TextMask::WIDTH;
+const int TextMask::HEIGHT;
+
+// clear every pixel
+void TextMask::clear()
+{
+    memset(rows, 0, sizeof(rows));
+    left = WIDTH;
+    right = -1;
+    top = HEIGHT;
+    bottom = -1;
+}
+
+// rasterise the text from the atlas glyphs, following Adafruit_GFX::write() for GFXfonts
+// at text size 1
+void TextMask::render(const char *text, const GlyphAtlas &atlas, int16_t x, int16_t y)
+{
+    clear();
+    if (text == nullptr)
+        return;
+
+    int16_t cursorX = x;
+    int16_t cursorY = y;
+    for (const char *c = text; *c != '\0'; c++)
+    {
+        if (*c == '\n')
+        {
+            cursorX = 0;
+            cursorY += atlas.getYAdvance();
+            continue;
+        }
+        const GlyphAtlas::Glyph *glyph = atlas.find(*c);
+        if (glyph == nullptr)
+            continue;
+        if (glyph->width > 0 && glyph->height > 0)
+        {
+            if (cursorX + glyph->xOffset + glyph->width > WIDTH)
+            {
+                cursorX = 0;
+                cursorY += atlas.getYAdvance();
+            }
+            blitGlyph(atlas, *glyph, cursorX + glyph->xOffset, cursorY + glyph->yOffset);
+        }
+        cursorX += glyph->xAdvance;
+    }
+    updateBounds();
+}
+
+// each glyph row is shifted to x and ORed into the mask row. bits shifted past either
+// side of the 64-bit row are off the panel, so clipping is mostly free
+void TextMask::blitGlyph(const GlyphAtlas &atlas, const GlyphAtlas::Glyph &glyph, int16_t x, int16_t y)
+{
+    if (x >= WIDTH || x <= -GLYPH_ATLAS_MAX_WIDTH)
+        return;
+    const uint64_t visible = (WIDTH == 64) ? ~(uint64_t)0 : (((uint64_t)1 << (WIDTH & 63)) - 1);
+    const uint32_t *glyphRows = atlas.getRows(glyph);
+    int firstRow = y < 0 ? -y : 0;
+    int lastRow = (y + glyph.height > HEIGHT) ? HEIGHT - y : glyph.height;
+    for (int row = firstRow; row < lastRow; row++)
+    {
+        uint64_t bits = glyphRows[row];
+        rows[y + row] |= ((x >= 0) ? (bits << x) : (bits >> -x)) & visible;
+    }
+}
+
+void TextMask::updateBounds()
+{
+    for (int y = 0; y < HEIGHT; y++)
+    {
+        uint64_t bits = rows[y];
+        if (bits == 0)
+            continue;
+        int first = __builtin_ctzll(bits);
+        int last = 63 - __builtin_clzll(bits);
+        if (first < left)
+            left = first;
+        if (last > right)
+            right = last;
+        if (y < top)
+            top = y;
+        bottom = y;
+    }
+}
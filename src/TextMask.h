@@ -0,0 +1,59 @@
+#ifndef TEXTMASK_H
+#define TEXTMASK_H
+
+#pragma once
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "FrameBuffer.h"
+#include "GlyphAtlas.h"
+
+// A line of text rasterised once into a 1-bit mask the size of the panel, with the
+// bounding box of the pixels set. The text is drawn exactly as Adafruit GFX's print()
+// draws it with a GFXfont at text size 1: (x,y) is the cursor on the baseline, glyphs
+// outside the font are skipped, and text wraps at the right edge of the panel.
+// Drawing the mask each frame is then a walk over the set pixels of its rows, instead of
+// walking the glyphs again. Only render() again when the text, font or position change.
+// The glyphs come from a GlyphAtlas, so whole glyph rows are ORed into the mask words
+// instead of decoding the font bit by bit.
+// Usage:
+//     TextMask mask;
+//     atlas.build(&FreeMonoBold12pt7b, "0123456789.*"); // see GlyphAtlas
+//     mask.render("21.5*", atlas, 10, 20);
+//     layer.setMask(mask, color); // a MaskLayer draws it, see Compositor
+class TextMask
+{
+public:
+    static const int WIDTH = FrameBuffer::WIDTH;
+    static const int HEIGHT = FrameBuffer::HEIGHT;
+    static_assert(WIDTH <= 64, "a mask row is one 64-bit word");
+
+    TextMask() { clear(); }
+
+    // rasterise text from the glyphs in atlas with the cursor at (x,y). pixels off the
+    // panel are clipped, characters not in the atlas are skipped
+    void render(const char *text, const GlyphAtlas &atlas, int16_t x, int16_t y);
+    void clear();
+
+    bool isEmpty() const { return top > bottom; }
+
+    // bit x set if pixel (x,y) is part of the text
+    uint64_t getRow(int y) const { return rows[y]; }
+
+    // bounding box of the set pixels, inclusive. empty if top > bottom
+    int getLeft() const { return left; }
+    int getRight() const { return right; }
+    int getTop() const { return top; }
+    int getBottom() const { return bottom; }
+
+private:
+    uint64_t rows[HEIGHT];
+    int left, right, top, bottom;
+
+    // OR a glyph's rows into the mask with its top left at (x,y)
+    void blitGlyph(const GlyphAtlas &atlas, const GlyphAtlas::Glyph &glyph, int16_t x, int16_t y);
+    // work out the bounding box from the rows
+    void updateBounds();
+};
+
+#endif
@@ -0,0 +1,71 @@
+#include "TimeHistogram.h"
+
+void TimeHistogram::clear()
+{
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+    minimum.store(UINT32_MAX, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+// below HISTOGRAM_LINEAR_BUCKETS µs a bucket per µs. above, the top bit's position picks
+// the doubling and the next two bits which quarter of it
+int TimeHistogram::bucketOf(uint32_t micros)
+{
+    if (micros < HISTOGRAM_LINEAR_BUCKETS)
+        return micros;
+    int exponent = 31 - __builtin_clz(micros);
+    if (exponent > HISTOGRAM_MAX_EXPONENT)
+        return HISTOGRAM_BUCKETS - 1;
+    int sub = (micros >> (exponent - 2)) & (HISTOGRAM_SUB_BUCKETS - 1);
+    return HISTOGRAM_LINEAR_BUCKETS + (exponent - 3) * HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+uint32_t TimeHistogram::bucketTop(int index)
+{
+    if (index < HISTOGRAM_LINEAR_BUCKETS)
+        return index;
+    if (index >= HISTOGRAM_BUCKETS - 1)
+        return UINT32_MAX;
+    int exponent = (index - HISTOGRAM_LINEAR_BUCKETS) / HISTOGRAM_SUB_BUCKETS + 3;
+    int sub = (index - HISTOGRAM_LINEAR_BUCKETS) % HISTOGRAM_SUB_BUCKETS;
+    uint32_t bottom = (uint32_t)(HISTOGRAM_SUB_BUCKETS + sub) << (exponent - 2);
+    return bottom + ((uint32_t)1 << (exponent - 2)) - 1;
+}
+
+void TimeHistogram::snapshot(HistogramSnapshot &snapshot) const
+{
+    // copy the buckets first, and count from the copy so the percentiles agree with it
+    uint32_t counts[HISTOGRAM_BUCKETS];
+    uint32_t n = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        n += counts[i];
+    }
+    snapshot.count = n;
+    snapshot.min = (n > 0) ? minimum.load(std::memory_order_relaxed) : 0;
+    snapshot.max = maximum.load(std::memory_order_relaxed);
+
+    // the bucket holding the sample ranked ceil(n * percent / 100)
+    uint32_t *percentiles[] = {&snapshot.p50, &snapshot.p95, &snapshot.p99};
+    const uint32_t percents[] = {50, 95, 99};
+    for (int p = 0; p < 3; p++)
+    {
+        uint32_t rank = (uint32_t)(((uint64_t)n * percents[p] + 99) / 100);
+        uint32_t seen = 0;
+        uint32_t value = 0;
+        for (int i = 0; i < HISTOGRAM_BUCKETS && n > 0; i++)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+            {
+                value = bucketTop(i);
+                break;
+            }
+        }
+        *percentiles[p] = (value > snapshot.max) ? snapshot.max : value;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef TIMEHISTOGRAM_H
+#define TIMEHISTOGRAM_H
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+#define HISTOGRAM_LINEAR_BUCKETS 8     // one bucket per µs below this
+#define HISTOGRAM_SUB_BUCKETS 4        // buckets per doubling above it, so within 25%
+#define HISTOGRAM_MAX_EXPONENT 24      // times past 2^24 µs (~17 s) all land in the last bucket
+#define HISTOGRAM_BUCKETS (HISTOGRAM_LINEAR_BUCKETS + (HISTOGRAM_MAX_EXPONENT - 3 + 1) * HISTOGRAM_SUB_BUCKETS)
+
+// summary of a TimeHistogram, all times in µs
+struct HistogramSnapshot
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t p50;
+    uint32_t p95;
+    uint32_t p99;
+};
+
+// Histogram of times in µs with fixed log-scale buckets, for min/max/percentiles of a
+// pipeline stage without keeping every sample. Recording is a few loads and stores.
+// One task records; any task can take a snapshot at any time without stopping it,
+// reading the counters as they are (a sample being recorded may be half counted).
+// Percentiles are the top of the bucket they fall in, at most 25% high and never above max.
+// Usage:
+//     TimeHistogram drawTimes;
+//     drawTimes.record(micros() - tStart);   // the recording task
+//     HistogramSnapshot s;
+//     drawTimes.snapshot(s);                 // any task
+//     Logger::printf("p99 %lu\n", (unsigned long)s.p99);
+class TimeHistogram
+{
+public:
+    TimeHistogram() { clear(); }
+
+    // add one time. only call from one task
+    void record(uint32_t micros)
+    {
+        int index = bucketOf(micros);
+        buckets[index].store(buckets[index].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (micros < minimum.load(std::memory_order_relaxed))
+            minimum.store(micros, std::memory_order_relaxed);
+        if (micros > maximum.load(std::memory_order_relaxed))
+            maximum.store(micros, std::memory_order_relaxed);
+    }
+
+    // summarise the times recorded so far. safe from any task
+    void snapshot(HistogramSnapshot &snapshot) const;
+
+    // forget all times. only call from the recording task
+    void clear();
+
+    // bucket a time falls in, and the largest time in a bucket
+    static int bucketOf(uint32_t micros);
+    static uint32_t bucketTop(int index);
+
+private:
+    std::atomic<uint32_t> buckets[HISTOGRAM_BUCKETS];
+    std::atomic<uint32_t> minimum;
+    std::atomic<uint32_t> maximum;
+};
+
+#endif
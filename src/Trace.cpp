@@ -0,0 +1,174 @@
+#include "Trace.h"
+
+#if TRACE_ENABLED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "Logger.h"
+#else
+#include <chrono>
+#endif
+
+std::atomic<Trace::Ring *> Trace::rings[TRACE_MAX_THREADS];
+std::atomic<int> Trace::ringCount(0);
+std::atomic<uint32_t> Trace::droppedZones(0);
+
+#ifdef ARDUINO
+uint64_t Trace::nowMicros64() { return esp_timer_get_time(); }
+uint32_t Trace::nowTicks() { return ESP.getCycleCount(); }
+uint32_t Trace::ticksPerMicro() { return ESP.getCpuFreqMHz(); }
+#else
+static uint64_t steadyNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+uint64_t Trace::nowMicros64() { return steadyNanos() / 1000; }
+uint32_t Trace::nowTicks() { return (uint32_t)steadyNanos(); }
+uint32_t Trace::ticksPerMicro() { return 1000; }
+#endif
+
+Trace::Ring *Trace::threadRing()
+{
+    // this task's ring, claimed on its first zone. -1 before that, TRACE_MAX_THREADS if
+    // there was none to claim
+    static thread_local int ringIndex = -1;
+    static thread_local Ring *ring = nullptr;
+    if (ringIndex < 0)
+    {
+        ringIndex = ringCount.fetch_add(1);
+        if (ringIndex >= TRACE_MAX_THREADS)
+        {
+            ringIndex = TRACE_MAX_THREADS; // none left, don't claim again
+            return nullptr;
+        }
+#ifdef ARDUINO
+        void *memory = heap_caps_malloc(sizeof(Ring), MALLOC_CAP_SPIRAM);
+        if (memory == nullptr)
+            memory = heap_caps_malloc(sizeof(Ring), MALLOC_CAP_INTERNAL);
+#else
+        void *memory = malloc(sizeof(Ring));
+#endif
+        if (memory == nullptr)
+            return nullptr; // the slot stays empty and the task's zones are dropped
+        ring = new (memory) Ring();
+        ring->head.store(0, std::memory_order_relaxed);
+#ifdef ARDUINO
+        snprintf(ring->threadName, sizeof(ring->threadName), "%s", pcTaskGetName(NULL));
+#else
+        snprintf(ring->threadName, sizeof(ring->threadName), "Thread %d", ringIndex);
+#endif
+        // the name and head are set before a dump can see the ring
+        rings[ringIndex].store(ring, std::memory_order_release);
+    }
+    return ring;
+}
+
+void Trace::record(const char *name, uint32_t startMicros, uint32_t startTicks)
+{
+    uint32_t duration = nowTicks() - startTicks;
+    Ring *ring = threadRing();
+    if (ring == nullptr)
+    {
+        droppedZones.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // only this task writes its ring. the head is published after the event,
+    // so a reader knows which events are complete
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    TraceEvent &event = ring->events[head % TRACE_RING_EVENTS];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(startMicros, std::memory_order_relaxed);
+    event.duration.store(duration, std::memory_order_relaxed);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void Trace::write(LineWriter writer, void *context)
+{
+    char line[192];
+    // start times are µs truncated to 32 bits, so they wrap after ~71 minutes.
+    // each is placed by its age, so the zones in the rings stay in order across a wrap
+    uint64_t now = nowMicros64();
+    uint32_t now32 = (uint32_t)now;
+    uint32_t ticks = ticksPerMicro();
+
+    writer("{\"traceEvents\":[\n", context);
+    int count = ringCount.load();
+    if (count > TRACE_MAX_THREADS)
+        count = TRACE_MAX_THREADS;
+    const char *separator = "";
+    for (int tid = 0; tid < count; tid++)
+    {
+        // not allocated yet, or couldn't be
+        Ring *claimed = rings[tid].load(std::memory_order_acquire);
+        if (claimed == nullptr)
+            continue;
+        Ring &ring = *claimed;
+        snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%.23s\"}}\n",
+                 separator, tid, ring.threadName);
+        writer(line, context);
+        separator = ",";
+
+        // the last TRACE_RING_EVENTS zones, oldest first
+        uint32_t head = ring.head.load(std::memory_order_acquire);
+        uint32_t first = (head > TRACE_RING_EVENTS) ? head - TRACE_RING_EVENTS : 0;
+        for (uint32_t i = first; i < head; i++)
+        {
+            TraceEvent &event = ring.events[i % TRACE_RING_EVENTS];
+            const char *name = event.name.load(std::memory_order_relaxed);
+            uint32_t start = event.start.load(std::memory_order_relaxed);
+            uint32_t duration = event.duration.load(std::memory_order_relaxed);
+            // the task kept recording meanwhile. skip the zone if its slot has been reused
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (ring.head.load(std::memory_order_relaxed) - i >= TRACE_RING_EVENTS)
+                continue;
+
+            uint64_t ts = now - (uint32_t)(now32 - start);
+            snprintf(line, sizeof(line), ",{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%llu,\"dur\":%lu.%03lu}\n",
+                     name, tid, (unsigned long long)ts,
+                     (unsigned long)(duration / ticks), (unsigned long)((duration % ticks) * 1000 / ticks));
+            writer(line, context);
+        }
+    }
+    writer("]}\n", context);
+}
+
+#ifdef ARDUINO
+static void writeToLogger(const char *line, void *context)
+{
+    Logger::print(line);
+}
+
+void Trace::dump()
+{
+    write(writeToLogger, nullptr);
+}
+#else
+static void writeToFile(const char *line, void *context)
+{
+    fputs(line, static_cast<FILE *>(context));
+}
+
+void Trace::dump()
+{
+    write(writeToFile, stdout);
+}
+
+bool Trace::writeFile(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == nullptr)
+        return false;
+    write(writeToFile, file);
+    fclose(file);
+    return true;
+}
+#endif
+
+#endif
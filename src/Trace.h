@@ -0,0 +1,117 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// TRACE MASTER TOGGLE - build with -DTRACE_ENABLED=0 to compile the zones out
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+#define TRACE_MAX_THREADS 8   // tasks that can record zones, later ones are dropped
+#define TRACE_RING_EVENTS 256 // zones kept per task, the oldest are overwritten
+
+// Scoped trace zones for a timeline of where time goes across tasks.
+// A zone records when it began and how long it took when it goes out of scope, into a
+// ring of the last TRACE_RING_EVENTS zones of the task it ran on. Each task has its own
+// ring, so recording takes no lock: three clock reads and a few stores.
+// Start times come from the esp_timer, which both cores share, so tasks line up on one
+// timeline. Durations come from the cycle counter (steady_clock on host builds).
+// The rings can be written out as Chrome Trace Event JSON (chrome://tracing or Perfetto)
+// at any time, while the zones keep recording.
+// Zone names must be string literals, or live as long as the trace.
+// A task's ring is allocated on its first zone, in PSRAM where there is some: 3 KB a task
+// that records zones, and nothing for the rest. Only the ring pointers are static.
+// With TRACE_ENABLED 0 the macros expand to nothing.
+// Usage:
+//     void MyClass::update()
+//     {
+//         TRACE_ZONE("Update"); // from here to the end of the scope
+//         ...
+//     }
+//     TRACE_DUMP();             // the JSON over serial
+//     Trace::writeFile("t.json") // host builds only
+
+#if TRACE_ENABLED
+
+// one zone, as recorded. fields are atomic so a dump can read them while they're written
+struct TraceEvent
+{
+    std::atomic<const char *> name;
+    std::atomic<uint32_t> start;    // µs
+    std::atomic<uint32_t> duration; // clock ticks, see Trace::ticksPerMicro()
+};
+
+class Trace
+{
+public:
+    // current time in µs, and in ticks of the duration clock
+    static uint32_t nowMicros() { return (uint32_t)nowMicros64(); }
+    static uint32_t nowTicks();
+    static uint32_t ticksPerMicro();
+
+    // record a zone that started at the given times, on the calling task's ring
+    static void record(const char *name, uint32_t startMicros, uint32_t startTicks);
+
+    // write the rings as Chrome Trace Event JSON, a line at a time
+    typedef void (*LineWriter)(const char *line, void *context);
+    static void write(LineWriter writer, void *context);
+    // write the JSON to serial. other tasks' logging may land in between its lines
+    static void dump();
+#ifndef ARDUINO
+    // write the JSON to a file. returns false if it couldn't be opened
+    static bool writeFile(const char *path);
+#endif
+
+    // zones not recorded, as their task had no ring left or it couldn't be allocated
+    static uint32_t getDroppedZones() { return droppedZones.load(); }
+
+private:
+    struct Ring
+    {
+        char threadName[24];
+        std::atomic<uint32_t> head; // zones ever recorded, the next goes in head % TRACE_RING_EVENTS
+        TraceEvent events[TRACE_RING_EVENTS];
+    };
+
+    // null until the task that claimed it has allocated it
+    static std::atomic<Ring *> rings[TRACE_MAX_THREADS];
+    static std::atomic<int> ringCount;
+    static std::atomic<uint32_t> droppedZones;
+
+    static uint64_t nowMicros64();
+
+    // the calling task's ring, claimed and allocated on its first zone. null if there are
+    // none left or it couldn't be allocated
+    static Ring *threadRing();
+};
+
+// records the zone when it goes out of scope. use TRACE_ZONE rather than this directly
+class TraceZone
+{
+public:
+    explicit TraceZone(const char *name) : name(name), startMicros(Trace::nowMicros()), startTicks(Trace::nowTicks()) {}
+    ~TraceZone() { Trace::record(name, startMicros, startTicks); }
+
+private:
+    const char *name;
+    uint32_t startMicros;
+    uint32_t startTicks;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_DUMP() Trace::dump()
+
+#else
+
+#define TRACE_ZONE(name)
+#define TRACE_DUMP()
+
+#endif
+
+#endif
@@ -11,6 +11,9 @@
 #include "InputHandler.h"
 #include "MODES.h"
 #include "OTAHandler.h"
+#include "CpuMonitor.h"
+#include "MemoryMonitor.h"
+#include "Trace.h"
 
 #include "fonts/Roboto_Black_22.h"
 #include "fonts/Led_Matrix_Font_5x3.h"
@@ -42,6 +45,8 @@
 
 #define POLLING_INTERVAL_MS 50 // Input polling interval in milliseconds
 #define SWITCH_DEBOUNCE_MS 150 // Switch debounce time in milliseconds
+#define TRACE_DUMP_KEY 't'     // send over serial to dump the trace zones as Chrome trace JSON
+#define NEXT_RULE_KEY 'r'      // send over serial to switch the Game of Life matrices to the next rule
 
 // onboard RGB LED object
 Adafruit_NeoPixel pixel(1, RGB_PIN, NEO_GRB + NEO_KHZ800);
@@ -56,6 +61,7 @@ MatrixDriver *matrixDriver; // Driver to update panel from matrix
 GY21Sensor *gy21Sensor;     // Temperature and humidity sensor
 InputHandler *inputHandler; // Input handler for brightness, hue, modes
 OTAHandler *otaHandler;     // OTA update handler
+CpuMonitor *cpuMonitor;     // per-task cpu use, logged every few seconds
 
 const int textOnlyFPS = 10; // desired frames per second
 const int gameLifeFPS = 15; // desired frames per second
@@ -63,6 +69,7 @@ const int plasmaFPS = 40;   // desired frames per second
 const int mainLoopFPS = 40; // desired main loop FPS
 
 void setNewDisplayMode();
+void handleSerialCommand(int command);
 void delayForFPS();
 
 // TESTING functions //////////////////////////////
@@ -80,6 +87,11 @@ int mode2 = MODES::MODE2_A;             // secondary mode
 int textWhiteOnly = true;               // whether text is white only or coloured based on hue
 uint16_t textHue = backHue;             // hue value for text
 
+// Game of Life rules switched between with NEXT_RULE_KEY, starting from the engine's default
+const char *lifeRules[] = {DEFAULT_LIFE_RULE, LIFE_RULE_CONWAY, LIFE_RULE_DAY_AND_NIGHT, LIFE_RULE_SEEDS};
+const int lifeRuleCount = sizeof(lifeRules) / sizeof(lifeRules[0]);
+int lifeRuleIndex = 0; // current rule of both Game of Life matrices
+
 void setup()
 {
   Logger::begin(115200);
@@ -92,27 +104,36 @@ void setup()
   pixel.begin();
   pixel.setBrightness(0);
 
+  // heap used by each subsystem created below is logged as it's created
+  MemoryMonitor::begin();
+
   otaHandler = new OTAHandler(WIFI_SSID, WIFI_PASSWORD,
                               "LEDMATRIXBOX", // hostname for mDNS
                               30000);         // try to reconnect every 30 seconds after disconnect
+  MemoryMonitor::checkpoint("OTA/WiFi");
 
-  gameLifeMatrix = new GameLifeMatrix(45, true); // 45% initial density, edge wrap enabled
+  gameLifeMatrix = new GameLifeMatrix(45); // 45% initial density, edges wrap
   Logger::println("Game of Life Matrix initialized");
+  MemoryMonitor::checkpoint("GameLifeMatrix");
 
   plasmaMatrix = new PlasmaMatrix();
   Logger::println("Plasma Matrix initialized");
+  MemoryMonitor::checkpoint("PlasmaMatrix");
 
-  gameLifeMatrix2 = new GameLifeMatrix2(45, true); // 45% initial density, edge wrap enabled
+  gameLifeMatrix2 = new GameLifeMatrix2(45); // 45% initial density, edges wrap
   Logger::println("Game of Life Matrix 2 initialized");
+  MemoryMonitor::checkpoint("GameLifeMatrix2");
 
   // set initial matrix
   currentMatrix = gameLifeMatrix;
 
   panel = new Panel(brightness, true); // brightness 0-255, double buffering enabled
   Logger::println("Panel initialized");
+  MemoryMonitor::checkpoint("Panel");
 
   gy21Sensor = new GY21Sensor(GY21_SDA, GY21_SCL, 500); // update twice a second
   Logger::println("GY21Sensor initialized");
+  MemoryMonitor::checkpoint("GY21Sensor");
 
   inputHandler = new InputHandler(POLLING_INTERVAL_MS,
                                   BRIGHT_ENC_A, BRIGHT_ENC_B, BRIGHT_ENC_SW,
@@ -126,6 +147,7 @@ void setup()
                                   255, 32768);                          // starting brightness and hue
 
   Logger::println("InputHandler initialized");
+  MemoryMonitor::checkpoint("InputHandler");
 
   // create MatrixDriver to update panel from matrix at FPS
   matrixDriver = new MatrixDriver(gameLifeFPS, panel, currentMatrix, gy21Sensor,
@@ -137,6 +159,7 @@ void setup()
   matrixDriver->setHumidityTextXOffset(10);
   matrixDriver->setHumidityTextYOffset(12);
   Logger::println("MatrixDriver initialized");
+  MemoryMonitor::checkpoint("MatrixDriver");
 
   delay(100);
 
@@ -151,6 +174,14 @@ void setup()
   // now resume input handler polling
   inputHandler->resume();
   Logger::println("InputHandler resumed");
+
+  // and sample cpu use once every task is running
+  cpuMonitor = new CpuMonitor();
+  cpuMonitor->resume();
+  Logger::println("CpuMonitor resumed");
+  MemoryMonitor::checkpoint("CpuMonitor");
+
+  MemoryMonitor::logSnapshot("Boot");
 }
 
 void loop()
@@ -163,6 +194,14 @@ void loop()
 
   bool valueChanged = false; // for logging only
 
+  TRACE_ZONE("Loop");
+
+  // single key commands over serial
+  if (Serial.available() > 0)
+  {
+    handleSerialCommand(Serial.read());
+  }
+
   // check for OTA updates
   otaHandler->handle();
 
@@ -344,11 +383,38 @@ void setNewDisplayMode()
     Logger::println("Unknown mode selected!");
     break;
   }
+
+  // heaps and stack high-water marks so far, to see what each mode costs
+  MemoryMonitor::logSnapshot("Mode switch");
+}
+
+// act on a key sent over serial
+void handleSerialCommand(int command)
+{
+  switch (command)
+  {
+  case NEXT_RULE_KEY:
+    // both matrices take the new rule at the start of their next frame
+    lifeRuleIndex = (lifeRuleIndex + 1) % lifeRuleCount;
+    gameLifeMatrix->setRule(lifeRules[lifeRuleIndex]);
+    gameLifeMatrix2->setRule(lifeRules[lifeRuleIndex]);
+    Logger::printf("Game of Life rule requested: %s\n", lifeRules[lifeRuleIndex]);
+    break;
+#if TRACE_ENABLED
+  case TRACE_DUMP_KEY:
+    // dump the trace zones as Chrome trace JSON
+    TRACE_DUMP();
+    break;
+#endif
+  default:
+    break;
+  }
 }
 
 // delay to maintain desired main loop FPS (approximate timing)
 void delayForFPS()
 {
+  TRACE_ZONE("Loop delay");
   // main loop timing to maintain desired FPS
   static unsigned long lastLoopTime = 0;
   unsigned long currentLoopTime = millis();
@@ -0,0 +1,75 @@
+#ifndef HOST_ADAFRUIT_NEOPIXEL_H
+#define HOST_ADAFRUIT_NEOPIXEL_H
+
+#pragma once
+
+// Host stand-in for Adafruit NeoPixel: only the colour helper the matrices use,
+// following the library's ColorHSV()
+
+#include <Arduino.h>
+
+class Adafruit_NeoPixel
+{
+public:
+    // packed 0x00RRGGBB colour of hue 0-65535, saturation and value 0-255
+    static uint32_t ColorHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255)
+    {
+        uint8_t r, g, b;
+        hue = (hue * 1530L + 32768) / 65536;
+        if (hue < 510)
+        {
+            b = 0;
+            if (hue < 255)
+            {
+                r = 255;
+                g = hue;
+            }
+            else
+            {
+                r = 510 - hue;
+                g = 255;
+            }
+        }
+        else if (hue < 1020)
+        {
+            r = 0;
+            if (hue < 765)
+            {
+                g = 255;
+                b = hue - 510;
+            }
+            else
+            {
+                g = 1020 - hue;
+                b = 255;
+            }
+        }
+        else if (hue < 1530)
+        {
+            g = 0;
+            if (hue < 1275)
+            {
+                r = hue - 1020;
+                b = 255;
+            }
+            else
+            {
+                r = 255;
+                b = 1530 - hue;
+            }
+        }
+        else
+        {
+            r = 255;
+            g = b = 0;
+        }
+        uint32_t v1 = 1 + val;
+        uint16_t s1 = 1 + sat;
+        uint8_t s2 = 255 - sat;
+        return ((((((r * s1) >> 8) + s2) * v1) & 0xff00) << 8) |
+               (((((g * s1) >> 8) + s2) * v1) & 0xff00) |
+               (((((b * s1) >> 8) + s2) * v1) >> 8);
+    }
+};
+
+#endif
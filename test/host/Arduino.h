@@ -0,0 +1,300 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#pragma once
+
+// Host stand-in for the parts of the Arduino core and FreeRTOS the portable modules use,
+// so they can be built and unit tested with [env:native] (pio test -e native).
+// Tasks are std::threads, named and pinned to their core when the host has it.
+// Semaphores and task notifications are a mutex and condition variable each.
+// A tick is 1 ms of steady_clock, counted from the first call.
+// A task can't be stopped from another thread, so vTaskDelete() marks it deleted and waits
+// until it parks for good at its next block, e.g. a JobSystem worker waiting for a batch.
+// As on the target, it doesn't touch its owner's memory after that.
+// Serial writes to stdout.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <array> // the core's headers bring it in through <functional>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+#define PROGMEM
+#define IRAM_ATTR
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_pointer(addr) (*(void *const *)(addr))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// ---- time
+
+inline uint64_t hostMicros()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+inline unsigned long micros() { return (unsigned long)hostMicros(); }
+inline unsigned long millis() { return (unsigned long)(hostMicros() / 1000); }
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void delayMicroseconds(unsigned int us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+// ---- random numbers
+
+inline uint32_t esp_random()
+{
+    static std::random_device device;
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    return device();
+}
+inline void randomSeed(unsigned long seed) { srand(seed); }
+inline long random(long howBig) { return (howBig > 0) ? rand() % howBig : 0; }
+inline long random(long howSmall, long howBig) { return (howSmall < howBig) ? howSmall + random(howBig - howSmall) : howSmall; }
+
+template <class T, class L, class H>
+inline T constrain(T x, L low, H high) { return (x < low) ? low : ((x > high) ? high : x); }
+
+// ---- String, only as far as the modules use it
+
+class String : public std::string
+{
+public:
+    String(const char *text = "") : std::string(text) {}
+    String(const std::string &text) : std::string(text) {}
+};
+
+// ---- Serial
+
+class HostSerial
+{
+public:
+    void begin(unsigned long) {}
+    void print(const char *text) { fputs(text, stdout); }
+    void print(const String &text) { fputs(text.c_str(), stdout); }
+    void print(int number) { printf("%d", number); }
+    void print(float number, int decimals) { printf("%.*f", decimals, number); }
+    void println(const char *text) { puts(text); }
+    void println(const String &text) { puts(text.c_str()); }
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() { fflush(stdout); }
+};
+static HostSerial Serial __attribute__((unused));
+
+// ---- FreeRTOS
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portTICK_PERIOD_MS 1
+#define portNUM_PROCESSORS 2
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define configMAX_TASK_NAME_LEN 16
+
+struct HostTask
+{
+    char name[configMAX_TASK_NAME_LEN];
+    std::mutex mutex;
+    std::condition_variable changed;
+    uint32_t notifications = 0;
+    std::atomic<bool> deleted;
+    bool parked = false;
+    HostTask(const char *taskName) : deleted(false) { snprintf(name, sizeof(name), "%s", taskName); }
+};
+typedef HostTask *TaskHandle_t;
+
+// the calling thread's task. threads not made by xTaskCreatePinnedToCore, e.g. main(), get one on first use
+inline HostTask *&hostCurrentTaskSlot()
+{
+    static thread_local HostTask *task = nullptr;
+    return task;
+}
+inline HostTask *hostCurrentTask()
+{
+    HostTask *&task = hostCurrentTaskSlot();
+    if (task == nullptr)
+        task = new HostTask("main");
+    return task;
+}
+// a deleted task never runs again
+inline void hostParkIfDeleted()
+{
+    HostTask *task = hostCurrentTask();
+    if (task->deleted.load())
+    {
+        {
+            std::lock_guard<std::mutex> lock(task->mutex);
+            task->parked = true;
+            task->changed.notify_all();
+        }
+        while (true)
+            std::this_thread::sleep_for(std::chrono::hours(1));
+    }
+}
+
+inline TickType_t xTaskGetTickCount() { return (TickType_t)(hostMicros() / 1000); }
+
+inline void vTaskDelay(TickType_t ticks)
+{
+    hostParkIfDeleted();
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+    hostParkIfDeleted();
+}
+
+// pdFALSE if the wake time had already passed, so the task wasn't delayed
+inline BaseType_t xTaskDelayUntil(TickType_t *previousWake, TickType_t increment)
+{
+    hostParkIfDeleted();
+    *previousWake += increment;
+    int32_t remaining = (int32_t)(*previousWake - xTaskGetTickCount());
+    if (remaining <= 0)
+        return pdFALSE;
+    std::this_thread::sleep_for(std::chrono::milliseconds(remaining));
+    hostParkIfDeleted();
+    return pdTRUE;
+}
+inline void vTaskDelayUntil(TickType_t *previousWake, TickType_t increment) { xTaskDelayUntil(previousWake, increment); }
+
+// the stack size and priority are left to the host
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t /* stackDepth */,
+                                          void *parameters, UBaseType_t /* priority */, TaskHandle_t *handle,
+                                          BaseType_t core)
+{
+    HostTask *task = new HostTask(name);
+    if (handle != nullptr)
+        *handle = task;
+    std::thread([=]() {
+        hostCurrentTaskSlot() = task;
+        pthread_setname_np(pthread_self(), task->name);
+        if (core != tskNO_AFFINITY && core < (BaseType_t)std::thread::hardware_concurrency())
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(core, &cpus);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        }
+        hostParkIfDeleted();
+        function(parameters);
+    }).detach();
+    return pdPASS;
+}
+
+// returns once the task has parked
+inline void vTaskDelete(TaskHandle_t task)
+{
+    if (task == nullptr)
+        task = hostCurrentTask();
+    if (task == hostCurrentTask())
+    {
+        task->deleted.store(true);
+        hostParkIfDeleted(); // never returns
+    }
+    std::unique_lock<std::mutex> lock(task->mutex);
+    task->deleted.store(true);
+    task->changed.notify_all();
+    task->changed.wait(lock, [task]() { return task->parked; });
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return hostCurrentTask(); }
+inline char *pcTaskGetName(TaskHandle_t task) { return (task != nullptr ? task : hostCurrentTask())->name; }
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; } // not known on host
+inline BaseType_t xPortGetCoreID()
+{
+    int cpu = sched_getcpu();
+    return (cpu >= 0) ? cpu : 0;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+    hostParkIfDeleted();
+    HostTask *task = hostCurrentTask();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    auto notified = [task]() { return task->notifications > 0 || task->deleted.load(); };
+    if (ticksToWait == portMAX_DELAY)
+        task->changed.wait(lock, notified);
+    else
+        task->changed.wait_for(lock, std::chrono::milliseconds(ticksToWait), notified);
+    lock.unlock();
+    hostParkIfDeleted();
+    lock.lock();
+    uint32_t count = task->notifications;
+    if (count > 0)
+        task->notifications = clearCountOnExit ? 0 : count - 1;
+    return count;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    // notified under the lock, so a woken task can't free it first
+    std::lock_guard<std::mutex> lock(task->mutex);
+    task->notifications++;
+    task->changed.notify_all();
+    return pdPASS;
+}
+
+struct HostSemaphore
+{
+    std::mutex mutex;
+    std::condition_variable given;
+    UBaseType_t count;
+    UBaseType_t maxCount;
+    HostSemaphore(UBaseType_t maxCount, UBaseType_t initialCount) : count(initialCount), maxCount(maxCount) {}
+};
+typedef HostSemaphore *SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new HostSemaphore(1, 1); }
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return new HostSemaphore(1, 0); }
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+    return new HostSemaphore(maxCount, initialCount);
+}
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    auto available = [semaphore]() { return semaphore->count > 0; };
+    if (ticksToWait == portMAX_DELAY)
+        semaphore->given.wait(lock, available);
+    else if (!semaphore->given.wait_for(lock, std::chrono::milliseconds(ticksToWait), available))
+        return pdFALSE;
+    semaphore->count--;
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    // notified under the lock, so a woken taker can't delete it first
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (semaphore->count >= semaphore->maxCount)
+        return pdFALSE;
+    semaphore->count++;
+    semaphore->given.notify_one();
+    return pdTRUE;
+}
+
+#endif
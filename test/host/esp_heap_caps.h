@@ -0,0 +1,38 @@
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#pragma once
+
+// Host stand-in for the esp-idf heap capabilities API. The host has no internal SRAM and
+// PSRAM heaps, so each is a set of figures the tests fill in with hostHeap(caps)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+struct HostHeap
+{
+    size_t total;
+    size_t free;
+    size_t minimumFree;
+    size_t largestBlock;
+};
+
+// the PSRAM heap for MALLOC_CAP_SPIRAM, otherwise internal SRAM
+inline HostHeap &hostHeap(uint32_t caps)
+{
+    static HostHeap internal = {0, 0, 0, 0};
+    static HostHeap psram = {0, 0, 0, 0};
+    return (caps & MALLOC_CAP_SPIRAM) ? psram : internal;
+}
+
+inline size_t heap_caps_get_total_size(uint32_t caps) { return hostHeap(caps).total; }
+inline size_t heap_caps_get_free_size(uint32_t caps) { return hostHeap(caps).free; }
+inline size_t heap_caps_get_minimum_free_size(uint32_t caps) { return hostHeap(caps).minimumFree; }
+inline size_t heap_caps_get_largest_free_block(uint32_t caps) { return hostHeap(caps).largestBlock; }
+
+#endif
@@ -0,0 +1,185 @@
+#include <unity.h>
+#include <chrono>
+#include "ColorMath.h"
+#include "FastRandom.h"
+
+// the SWAR kernels against the same maths one channel of one pixel at a time
+
+static int red(uint16_t pixel) { return pixel >> 11; }
+static int green(uint16_t pixel) { return (pixel >> 5) & 0x3F; }
+static int blue(uint16_t pixel) { return pixel & 0x1F; }
+static uint16_t rgb(int r, int g, int b) { return (r << 11) | (g << 5) | b; }
+
+static uint16_t blendChannels(uint16_t base, uint16_t other, uint16_t weight)
+{
+    return rgb((red(base) * (256 - weight) + red(other) * weight) >> 8,
+               (green(base) * (256 - weight) + green(other) * weight) >> 8,
+               (blue(base) * (256 - weight) + blue(other) * weight) >> 8);
+}
+
+static uint16_t addChannels(uint16_t a, uint16_t b)
+{
+    return rgb(std::min(31, red(a) + red(b)), std::min(63, green(a) + green(b)), std::min(31, blue(a) + blue(b)));
+}
+
+static uint16_t maxChannels(uint16_t a, uint16_t b)
+{
+    return rgb(std::max(red(a), red(b)), std::max(green(a), green(b)), std::max(blue(a), blue(b)));
+}
+
+// the blend the Life engines did before, through 8-bit RGB
+static uint16_t blendRgb888(uint16_t base, uint16_t other, uint16_t weight)
+{
+    int r0 = (red(base) << 3) | (red(base) >> 2), r1 = (red(other) << 3) | (red(other) >> 2);
+    int g0 = (green(base) << 2) | (green(base) >> 4), g1 = (green(other) << 2) | (green(other) >> 4);
+    int b0 = (blue(base) << 3) | (blue(base) >> 2), b1 = (blue(other) << 3) | (blue(other) >> 2);
+    int r = (r0 * (256 - weight) + r1 * weight) >> 8;
+    int g = (g0 * (256 - weight) + g1 * weight) >> 8;
+    int b = (b0 * (256 - weight) + b1 * weight) >> 8;
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+static const uint16_t WEIGHTS[] = {0, 1, 50, 100, 128, 200, 255, 256};
+
+// both pixels of a word come out as if blended on their own
+static void test_blend_both_lanes()
+{
+    FastRandom rng(1);
+    for (uint16_t weight : WEIGHTS)
+    {
+        for (int i = 0; i < 20000; i++)
+        {
+            uint32_t base = rng.next(), other = rng.next();
+            uint32_t blended = ColorMath::blend565x2(base, other, weight);
+            TEST_ASSERT_EQUAL_HEX16(blendChannels(ColorMath::low(base), ColorMath::low(other), weight), ColorMath::low(blended));
+            TEST_ASSERT_EQUAL_HEX16(blendChannels(ColorMath::high(base), ColorMath::high(other), weight), ColorMath::high(blended));
+        }
+    }
+    TEST_ASSERT_EQUAL_HEX32(0x12345678, ColorMath::blend565x2(0x12345678, 0xFFFFFFFF, 0));
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, ColorMath::blend565x2(0x12345678, 0xFFFFFFFF, 256));
+}
+
+// on the 5/6-bit channels the blend is within one step of blending through 8-bit RGB
+static void test_blend_close_to_rgb888()
+{
+    FastRandom rng(2);
+    for (uint16_t weight : WEIGHTS)
+    {
+        for (int i = 0; i < 20000; i++)
+        {
+            uint16_t base = rng.next(), other = rng.next();
+            uint16_t swar = ColorMath::low(ColorMath::blend565x2(base, other, weight));
+            uint16_t reference = blendRgb888(base, other, weight);
+            TEST_ASSERT_INT_WITHIN(1, red(reference), red(swar));
+            TEST_ASSERT_INT_WITHIN(1, green(reference), green(swar));
+            TEST_ASSERT_INT_WITHIN(1, blue(reference), blue(swar));
+        }
+    }
+}
+
+static void test_add_saturate()
+{
+    FastRandom rng(3);
+    for (int i = 0; i < 200000; i++)
+    {
+        uint32_t a = rng.next(), b = rng.next();
+        uint32_t sum = ColorMath::addSaturate565x2(a, b);
+        TEST_ASSERT_EQUAL_HEX16(addChannels(ColorMath::low(a), ColorMath::low(b)), ColorMath::low(sum));
+        TEST_ASSERT_EQUAL_HEX16(addChannels(ColorMath::high(a), ColorMath::high(b)), ColorMath::high(sum));
+    }
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, ColorMath::addSaturate565x2(0xFFFFFFFF, 0xFFFFFFFF));
+}
+
+static void test_max()
+{
+    FastRandom rng(4);
+    for (int i = 0; i < 200000; i++)
+    {
+        uint32_t a = rng.next(), b = rng.next();
+        uint32_t larger = ColorMath::max565x2(a, b);
+        TEST_ASSERT_EQUAL_HEX16(maxChannels(ColorMath::low(a), ColorMath::low(b)), ColorMath::low(larger));
+        TEST_ASSERT_EQUAL_HEX16(maxChannels(ColorMath::high(a), ColorMath::high(b)), ColorMath::high(larger));
+    }
+}
+
+// rows of odd and even lengths, written in place over either input
+static void test_rows()
+{
+    FastRandom rng(5);
+    alignas(4) uint16_t a[67], b[67], dest[67];
+    const int counts[] = {0, 1, 2, 3, 64, 67};
+    for (int count : counts)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            a[i] = rng.next();
+            b[i] = rng.next();
+        }
+
+        ColorMath::blendRow565(dest, a, b, count, 77);
+        for (int i = 0; i < count; i++)
+            TEST_ASSERT_EQUAL_HEX16(blendChannels(a[i], b[i], 77), dest[i]);
+        ColorMath::addSaturateRow565(dest, a, b, count);
+        for (int i = 0; i < count; i++)
+            TEST_ASSERT_EQUAL_HEX16(addChannels(a[i], b[i]), dest[i]);
+        ColorMath::maxRow565(dest, a, b, count);
+        for (int i = 0; i < count; i++)
+            TEST_ASSERT_EQUAL_HEX16(maxChannels(a[i], b[i]), dest[i]);
+
+        // in place
+        memcpy(dest, a, sizeof(a));
+        ColorMath::blendRow565(dest, dest, b, count, 200);
+        for (int i = 0; i < count; i++)
+            TEST_ASSERT_EQUAL_HEX16(blendChannels(a[i], b[i], 200), dest[i]);
+        memcpy(dest, b, sizeof(b));
+        ColorMath::maxRow565(dest, a, dest, count);
+        for (int i = 0; i < count; i++)
+            TEST_ASSERT_EQUAL_HEX16(maxChannels(a[i], b[i]), dest[i]);
+    }
+}
+
+// a 64x32 frame blended through 8-bit RGB a pixel at a time, and with blendRow565(). not checked
+static void test_benchmark()
+{
+    const int pixels = 64 * 32;
+    const int frames = 2000;
+    alignas(4) static uint16_t a[pixels], b[pixels], dest[pixels];
+    FastRandom rng(6);
+    for (int i = 0; i < pixels; i++)
+    {
+        a[i] = rng.next();
+        b[i] = rng.next();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        for (int i = 0; i < pixels; i++)
+            dest[i] = blendRgb888(a[i], b[i], 200 + (frame & 1));
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++)
+        ColorMath::blendRow565(dest, a, b, pixels, 200 + (frame & 1));
+    auto end = std::chrono::steady_clock::now();
+
+    char message[96];
+    snprintf(message, sizeof(message), "per pixel %.2f us/frame, blendRow565 %.2f us/frame (%04X)",
+             std::chrono::duration<double, std::micro>(middle - start).count() / frames,
+             std::chrono::duration<double, std::micro>(end - middle).count() / frames, dest[5]);
+    TEST_MESSAGE(message);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_blend_both_lanes);
+    RUN_TEST(test_blend_close_to_rgb888);
+    RUN_TEST(test_add_saturate);
+    RUN_TEST(test_max);
+    RUN_TEST(test_rows);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
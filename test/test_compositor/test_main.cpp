@@ -0,0 +1,480 @@
+#include <unity.h>
+#include "Compositor.h"
+#include "FastRandom.h"
+#include "GlyphAtlas.h"
+#include "fonts/Matrix7x5.h"
+
+// Compositor frames against golden colours worked out by hand, and against a reference
+// that composes every layer over every pixel from scratch each frame
+
+static const int W = FrameBuffer::WIDTH;
+static const int H = FrameBuffer::HEIGHT;
+
+static FixedGlyphAtlas<95> atlas;
+
+static int red(uint16_t pixel) { return pixel >> 11; }
+static int green(uint16_t pixel) { return (pixel >> 5) & 0x3F; }
+static int blue(uint16_t pixel) { return pixel & 0x1F; }
+static uint16_t rgb(int r, int g, int b) { return (r << 11) | (g << 5) | b; }
+
+// one pixel, one channel at a time
+static uint16_t blendReference(uint16_t below, uint16_t pixel, BlendMode mode, uint16_t alpha)
+{
+    switch (mode)
+    {
+    case BLEND_REPLACE:
+        return pixel;
+    case BLEND_ALPHA:
+        return rgb((red(below) * (256 - alpha) + red(pixel) * alpha) >> 8,
+                   (green(below) * (256 - alpha) + green(pixel) * alpha) >> 8,
+                   (blue(below) * (256 - alpha) + blue(pixel) * alpha) >> 8);
+    case BLEND_ADD:
+        return rgb(std::min(31, red(below) + red(pixel)), std::min(63, green(below) + green(pixel)),
+                   std::min(31, blue(below) + blue(pixel)));
+    case BLEND_MAX:
+        return rgb(std::max(red(below), red(pixel)), std::max(green(below), green(pixel)),
+                   std::max(blue(below), blue(pixel)));
+    }
+    return 0;
+}
+
+static void randomFrame(FrameBuffer &frame, uint32_t seed)
+{
+    FastRandom rng(seed);
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++)
+            frame.at(x, y) = rng.next();
+}
+
+static TextMask renderMask(const char *text, int16_t x, int16_t y)
+{
+    TextMask mask;
+    mask.render(text, atlas, x, y);
+    return mask;
+}
+
+static void assertFramesEqual(const FrameBuffer &expected, const FrameBuffer &actual, const char *message)
+{
+    for (int y = 0; y < H; y++)
+    {
+        for (int x = 0; x < W; x++)
+        {
+            if (expected.at(x, y) != actual.at(x, y))
+            {
+                char text[96];
+                snprintf(text, sizeof(text), "%s, pixel (%d,%d)", message, x, y);
+                TEST_ASSERT_EQUAL_HEX16_MESSAGE(expected.at(x, y), actual.at(x, y), text);
+            }
+        }
+    }
+}
+
+// a layer that records what it's asked to draw
+class ProbeLayer : public Layer
+{
+public:
+    int composed = 0;
+    uint32_t lastRows = 0;
+    bool opaque = false;
+
+    ProbeLayer(const char *name) : Layer(name) {}
+
+    void compose(FrameBuffer &frame, uint32_t rows) override
+    {
+        composed++;
+        lastRows = rows;
+        for (int y = 0; y < H; y++)
+        {
+            if (opaque && (rows & ((uint32_t)1 << y)))
+                memset(frame.row(y), 0x11, W * sizeof(uint16_t));
+        }
+    }
+    bool isOpaque() const override { return opaque && isVisible(); }
+    uint32_t getCoveredRows() const override { return ALL_ROWS; }
+};
+
+static void setUpAtlas()
+{
+    TEST_ASSERT_TRUE(atlas.build(&Matrix7x5));
+}
+
+// a uniform layer over a uniform background, in every blend mode
+static void test_blend_modes_golden()
+{
+    static FrameBuffer backgroundFrame, layerFrame, frame;
+    backgroundFrame.fill(0x8410); // r 16, g 32, b 16
+    FrameLayer background("Background");
+    FrameLayer layer("Layer");
+    background.setFrame(&backgroundFrame);
+    Compositor compositor;
+    compositor.addLayer(&background);
+    compositor.addLayer(&layer);
+
+    struct Golden
+    {
+        BlendMode mode;
+        uint16_t alpha;
+        uint16_t color;
+        uint16_t expected;
+    };
+    const Golden goldens[] = {
+        {BLEND_REPLACE, 256, 0x1234, 0x1234},
+        {BLEND_ALPHA, 128, 0xFFFF, 0xBDF7}, // r 23, g 47, b 23, rounded down
+        {BLEND_ALPHA, 0, 0xFFFF, 0x8410},
+        {BLEND_ALPHA, 256, 0xFFFF, 0xFFFF},
+        {BLEND_ADD, 256, 0x0841, 0x8C51},   // r 17, g 34, b 17
+        {BLEND_ADD, 256, 0x8410, 0xFFFF},   // every channel saturates
+        {BLEND_MAX, 256, 0xF800, 0xFC10},   // r 31, g 32, b 16
+        {BLEND_MAX, 256, 0x0000, 0x8410},
+    };
+    for (const Golden &golden : goldens)
+    {
+        layerFrame.fill(golden.color);
+        layer.setFrame(&layerFrame);
+        layer.setBlendMode(golden.mode);
+        layer.setAlpha(golden.alpha);
+        TEST_ASSERT_EQUAL_HEX32(Layer::ALL_ROWS, compositor.compose(frame));
+        for (int y = 0; y < H; y++)
+            for (int x = 0; x < W; x++)
+                TEST_ASSERT_EQUAL_HEX16(golden.expected, frame.at(x, y));
+    }
+}
+
+// a text mask is drawn on its set pixels only, the rest shows what's below
+static void test_mask_layer_golden()
+{
+    setUpAtlas();
+    static FrameBuffer backgroundFrame, frame;
+    backgroundFrame.fill(0x8410);
+    FrameLayer background("Background");
+    MaskLayer text("Text", BLEND_MAX);
+    background.setFrame(&backgroundFrame);
+    TextMask mask = renderMask("8.5", 20, 18);
+    text.setMask(mask, 0xF800);
+    Compositor compositor;
+    compositor.addLayer(&background);
+    compositor.addLayer(&text);
+    compositor.compose(frame);
+
+    int textPixels = 0;
+    for (int y = 0; y < H; y++)
+    {
+        for (int x = 0; x < W; x++)
+        {
+            bool set = (mask.getRow(y) >> x) & 1;
+            textPixels += set ? 1 : 0;
+            TEST_ASSERT_EQUAL_HEX16(set ? 0xFC10 : 0x8410, frame.at(x, y));
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(10, textPixels);
+}
+
+// without an opaque layer the frame starts black
+static void test_no_opaque_layer_starts_black()
+{
+    setUpAtlas();
+    static FrameBuffer frame;
+    frame.fill(0x5555);
+    MaskLayer text("Text", BLEND_ADD);
+    TextMask mask = renderMask("1", 0, 10);
+    text.setMask(mask, 0x0841);
+    Compositor compositor;
+    compositor.addLayer(&text);
+    TEST_ASSERT_EQUAL_HEX32(Layer::ALL_ROWS, compositor.compose(frame));
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++)
+            TEST_ASSERT_EQUAL_HEX16(((mask.getRow(y) >> x) & 1) ? 0x0841 : 0, frame.at(x, y));
+}
+
+// only the rows that changed are composed and returned
+static void test_damaged_rows()
+{
+    setUpAtlas();
+    static FrameBuffer backgroundFrame, frame;
+    randomFrame(backgroundFrame, 1);
+    FrameLayer background("Background");
+    MaskLayer text("Text", BLEND_MAX);
+    background.setFrame(&backgroundFrame);
+    TextMask first = renderMask("1", 10, 12);
+    text.setMask(first, 0xFFFF);
+    Compositor compositor;
+    compositor.addLayer(&background);
+    compositor.addLayer(&text);
+    TEST_ASSERT_EQUAL_HEX32(Layer::ALL_ROWS, compositor.compose(frame));
+
+    // the same frame, unchanged, and the same mask
+    background.setFrame(&backgroundFrame, false);
+    text.setMask(first, 0xFFFF);
+    TEST_ASSERT_EQUAL_HEX32(0, compositor.compose(frame));
+
+    // a new text damages the rows where the masks differ
+    TextMask second = renderMask("7", 10, 12);
+    uint32_t differing = 0;
+    for (int y = 0; y < H; y++)
+    {
+        if (first.getRow(y) != second.getRow(y))
+            differing |= (uint32_t)1 << y;
+    }
+    TEST_ASSERT_NOT_EQUAL(0, differing);
+    text.setMask(second, 0xFFFF);
+    TEST_ASSERT_EQUAL_HEX32(differing, compositor.compose(frame));
+
+    // a new colour, blend mode or alpha damages the rows the text covers
+    text.setMask(second, 0x07E0);
+    TEST_ASSERT_EQUAL_HEX32(text.getCoveredRows(), compositor.compose(frame));
+    text.setBlendMode(BLEND_ADD);
+    TEST_ASSERT_EQUAL_HEX32(text.getCoveredRows(), compositor.compose(frame));
+    text.setAlpha(100);
+    TEST_ASSERT_EQUAL_HEX32(text.getCoveredRows(), compositor.compose(frame));
+    text.setEnabled(false);
+    TEST_ASSERT_EQUAL_HEX32(text.getCoveredRows(), compositor.compose(frame));
+    text.setEnabled(false);
+    TEST_ASSERT_EQUAL_HEX32(0, compositor.compose(frame));
+
+    compositor.invalidate();
+    TEST_ASSERT_EQUAL_HEX32(Layer::ALL_ROWS, compositor.compose(frame));
+    background.setFrame(&backgroundFrame);
+    TEST_ASSERT_EQUAL_HEX32(Layer::ALL_ROWS, compositor.compose(frame));
+}
+
+// indexed frames are looked up in their palette as they're composed, in any blend mode,
+// and the same indices under another palette are composed again
+static void test_indexed_frame_layer()
+{
+    static IndexFrameBuffer indices;
+    static FrameBuffer backgroundFrame, frame, expected;
+    uint16_t palettes[2][FrameView::PALETTE_SIZE];
+    FastRandom rng(5);
+    for (int i = 0; i < FrameView::PALETTE_SIZE; i++)
+    {
+        palettes[0][i] = rng.next();
+        palettes[1][i] = rng.next();
+    }
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++)
+            indices.at(x, y) = rng.next();
+    randomFrame(backgroundFrame, 6);
+
+    FrameLayer background("Background");
+    FrameLayer indexed("Indexed");
+    background.setFrame(&backgroundFrame);
+    indexed.setFrame(FrameView(&indices, palettes[0]));
+    Compositor compositor;
+    compositor.addLayer(&background);
+    compositor.addLayer(&indexed);
+    TEST_ASSERT_EQUAL_HEX32(Layer::ALL_ROWS, compositor.compose(frame));
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++)
+            expected.at(x, y) = palettes[0][indices.at(x, y)];
+    assertFramesEqual(expected, frame, "Replace");
+
+    // unchanged, then the same indices under the other palette
+    indexed.setFrame(FrameView(&indices, palettes[0]), false);
+    TEST_ASSERT_EQUAL_HEX32(0, compositor.compose(frame));
+    indexed.setFrame(FrameView(&indices, palettes[1]), false);
+    TEST_ASSERT_EQUAL_HEX32(Layer::ALL_ROWS, compositor.compose(frame));
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++)
+            expected.at(x, y) = palettes[1][indices.at(x, y)];
+    assertFramesEqual(expected, frame, "New palette");
+
+    // blended over the frame below
+    const BlendMode modes[] = {BLEND_ALPHA, BLEND_ADD, BLEND_MAX};
+    const char *names[] = {"Alpha", "Add", "Max"};
+    for (int m = 0; m < 3; m++)
+    {
+        indexed.setBlendMode(modes[m]);
+        indexed.setAlpha(90);
+        compositor.compose(frame);
+        for (int y = 0; y < H; y++)
+            for (int x = 0; x < W; x++)
+                expected.at(x, y) = blendReference(backgroundFrame.at(x, y), palettes[1][indices.at(x, y)], modes[m], 90);
+        assertFramesEqual(expected, frame, names[m]);
+    }
+
+    // no palette yet is black, no frame at all isn't drawn
+    indexed.setBlendMode(BLEND_REPLACE);
+    indexed.setFrame(FrameView(&indices, nullptr));
+    compositor.compose(frame);
+    expected.fill(0);
+    assertFramesEqual(expected, frame, "No palette");
+    indexed.setFrame(FrameView());
+    TEST_ASSERT_FALSE(indexed.isVisible());
+    compositor.compose(frame);
+    assertFramesEqual(backgroundFrame, frame, "No frame");
+}
+
+// layers under the topmost opaque one aren't drawn, and hidden layers never are
+static void test_covered_layers_skipped()
+{
+    ProbeLayer bottom("Bottom"), middle("Middle"), top("Top");
+    static FrameBuffer frame;
+    Compositor compositor;
+    compositor.addLayer(&bottom);
+    compositor.addLayer(&middle);
+    compositor.addLayer(&top);
+
+    middle.opaque = true;
+    compositor.compose(frame);
+    TEST_ASSERT_EQUAL_INT(0, bottom.composed);
+    TEST_ASSERT_EQUAL_INT(1, middle.composed);
+    TEST_ASSERT_EQUAL_INT(1, top.composed);
+    TEST_ASSERT_EQUAL_HEX32(Layer::ALL_ROWS, top.lastRows);
+    TEST_ASSERT_EQUAL_UINT32(0, compositor.getLayer(0)->getCost());
+
+    // nothing damaged, nothing drawn
+    compositor.compose(frame);
+    TEST_ASSERT_EQUAL_INT(1, middle.composed);
+
+    middle.setEnabled(false);
+    compositor.compose(frame);
+    TEST_ASSERT_EQUAL_INT(1, bottom.composed);
+    TEST_ASSERT_EQUAL_INT(1, middle.composed);
+    TEST_ASSERT_EQUAL_INT(2, top.composed);
+}
+
+static void test_layer_limit()
+{
+    ProbeLayer layer("Layer");
+    Compositor compositor;
+    for (int i = 0; i < COMPOSITOR_MAX_LAYERS; i++)
+        TEST_ASSERT_TRUE(compositor.addLayer(&layer));
+    TEST_ASSERT_FALSE(compositor.addLayer(&layer));
+    TEST_ASSERT_EQUAL_INT(COMPOSITOR_MAX_LAYERS, compositor.getLayerCount());
+}
+
+// what's set on each layer of the scene, for the reference
+struct LayerState
+{
+    bool isMask;
+    BlendMode mode;
+    uint16_t alpha;
+    bool enabled;
+    const FrameBuffer *frame;
+    TextMask mask;
+    uint16_t color;
+};
+
+// every visible layer over every pixel, bottom up from black
+static void composeReference(const LayerState *states, int count, FrameBuffer &frame)
+{
+    frame.fill(0);
+    for (int i = 0; i < count; i++)
+    {
+        const LayerState &state = states[i];
+        if (!state.enabled || (!state.isMask && state.frame == nullptr))
+            continue;
+        for (int y = 0; y < H; y++)
+        {
+            for (int x = 0; x < W; x++)
+            {
+                if (state.isMask && !((state.mask.getRow(y) >> x) & 1))
+                    continue;
+                uint16_t pixel = state.isMask ? state.color : state.frame->at(x, y);
+                frame.at(x, y) = blendReference(frame.at(x, y), pixel, state.mode, state.alpha);
+            }
+        }
+    }
+}
+
+// random changes to a scene of frame and mask layers, frame after frame. the composed
+// frame, and a panel only written the rows compose() returns, must match the reference
+static void test_random_scenes_match_reference()
+{
+    setUpAtlas();
+    static FrameBuffer sources[3], frame, panel, expected;
+    for (int i = 0; i < 3; i++)
+        randomFrame(sources[i], 10 + i);
+
+    FrameLayer background("Background");
+    FrameLayer overlay("Overlay", BLEND_ALPHA);
+    MaskLayer text("Text", BLEND_MAX);
+    MaskLayer marker("Marker", BLEND_ADD);
+    Layer *layers[] = {&background, &overlay, &text, &marker};
+    const int layerCount = 4;
+    static LayerState states[layerCount];
+    Compositor compositor;
+    for (int i = 0; i < layerCount; i++)
+    {
+        compositor.addLayer(layers[i]);
+        states[i].isMask = i >= 2;
+        states[i].alpha = 256;
+        states[i].enabled = true;
+        states[i].frame = nullptr;
+        states[i].mask.clear();
+        states[i].color = 0xFFFF;
+    }
+    states[0].mode = BLEND_REPLACE;
+    states[1].mode = BLEND_ALPHA;
+    states[2].mode = BLEND_MAX;
+    states[3].mode = BLEND_ADD;
+
+    const char *const texts[] = {"", "21.5*", "-3.7", "88", "Hi!", "0123456789"};
+    const BlendMode modes[] = {BLEND_REPLACE, BLEND_ALPHA, BLEND_ADD, BLEND_MAX};
+    FastRandom rng(2024);
+    for (int step = 0; step < 3000; step++)
+    {
+        int i = rng.nextBelow(layerCount);
+        LayerState &state = states[i];
+        switch (rng.nextBelow(5))
+        {
+        case 0:
+            state.enabled = rng.nextBelow(4) != 0;
+            layers[i]->setEnabled(state.enabled);
+            break;
+        case 1:
+            state.mode = modes[rng.nextBelow(4)];
+            layers[i]->setBlendMode(state.mode);
+            break;
+        case 2:
+            state.alpha = rng.nextBelow(257);
+            layers[i]->setAlpha(state.alpha);
+            break;
+        default:
+            if (state.isMask)
+            {
+                state.mask = renderMask(texts[rng.nextBelow(6)], (int)rng.nextBelow(W) - 8, rng.nextBelow(H + 8));
+                state.color = (rng.nextBelow(2) != 0) ? state.color : (uint16_t)rng.next();
+                static_cast<MaskLayer *>(layers[i])->setMask(state.mask, state.color);
+            }
+            else
+            {
+                // the sources never change, so the same one is set as unchanged
+                int source = rng.nextBelow(4);
+                const FrameBuffer *next = (source < 3) ? &sources[source] : nullptr;
+                static_cast<FrameLayer *>(layers[i])->setFrame(next, next != state.frame);
+                state.frame = next;
+            }
+            break;
+        }
+
+        uint32_t rows = compositor.compose(frame);
+        for (int y = 0; y < H; y++)
+        {
+            if (rows & ((uint32_t)1 << y))
+                memcpy(panel.row(y), frame.row(y), W * sizeof(uint16_t));
+        }
+        composeReference(states, layerCount, expected);
+        char message[32];
+        snprintf(message, sizeof(message), "step %d", step);
+        assertFramesEqual(expected, frame, message);
+        assertFramesEqual(expected, panel, message);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_blend_modes_golden);
+    RUN_TEST(test_mask_layer_golden);
+    RUN_TEST(test_no_opaque_layer_starts_black);
+    RUN_TEST(test_damaged_rows);
+    RUN_TEST(test_indexed_frame_layer);
+    RUN_TEST(test_covered_layers_skipped);
+    RUN_TEST(test_layer_limit);
+    RUN_TEST(test_random_scenes_match_reference);
+    return UNITY_END();
+}
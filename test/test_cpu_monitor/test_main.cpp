@@ -0,0 +1,156 @@
+#include <unity.h>
+#include <chrono>
+#include <thread>
+#include "CpuMonitor.h"
+
+// CpuMonitor's host path: the threads of this process read from /proc, so a task kept
+// busy, one mostly asleep, and the sampling window can be checked against what they did
+
+static CpuMonitor *monitor;
+static std::atomic<bool> stopTasks;
+
+static void busyTask(void *)
+{
+    volatile uint32_t x = 0;
+    while (!stopTasks.load())
+        x = x * 1664525u + 1013904223u;
+    vTaskDelete(NULL);
+}
+
+static void sleepyTask(void *)
+{
+    while (!stopTasks.load())
+        vTaskDelay(pdMS_TO_TICKS(5));
+    vTaskDelete(NULL);
+}
+
+static void sleepMS(int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+static const CpuTaskLoad *findTask(const CpuReport &report, const char *name)
+{
+    for (int i = 0; i < report.taskCount; i++)
+    {
+        if (strcmp(report.tasks[i].name, name) == 0)
+            return &report.tasks[i];
+    }
+    return nullptr;
+}
+
+// no report until there are two samples to take the difference of
+static void test_needs_two_samples()
+{
+    static CpuReport report;
+    monitor->getReport(report);
+    TEST_ASSERT_EQUAL_UINT32(0, report.windowMicros);
+    TEST_ASSERT_EQUAL_INT(0, report.taskCount);
+    monitor->sample();
+    monitor->getReport(report);
+    TEST_ASSERT_EQUAL_UINT32(0, report.windowMicros);
+    sleepMS(5);
+    monitor->sample();
+    monitor->getReport(report);
+    TEST_ASSERT_GREATER_THAN(0, report.windowMicros);
+    TEST_ASSERT_GREATER_THAN(0, report.taskCount);
+}
+
+// a spinning task shows up busy, pinned to its core, and first; a sleeping one nearly idle
+static void test_busy_and_sleeping_tasks()
+{
+    static CpuReport report;
+    TaskHandle_t busy, sleepy;
+    stopTasks.store(false);
+    xTaskCreatePinnedToCore(busyTask, "Busy", 4096, nullptr, 1, &busy, 0);
+    xTaskCreatePinnedToCore(sleepyTask, "Sleepy", 4096, nullptr, 1, &sleepy, tskNO_AFFINITY);
+    sleepMS(20);
+    monitor->sample();
+    sleepMS(300);
+    monitor->sample();
+    stopTasks.store(true);
+    monitor->getReport(report);
+
+    TEST_ASSERT_INT_WITHIN(100000, 350000, report.windowMicros);
+    const CpuTaskLoad *busyLoad = findTask(report, "Busy");
+    const CpuTaskLoad *sleepyLoad = findTask(report, "Sleepy");
+    TEST_ASSERT_NOT_NULL(busyLoad);
+    TEST_ASSERT_NOT_NULL(sleepyLoad);
+    // every other thread is asleep, so the busy one has a core to itself
+    TEST_ASSERT_GREATER_THAN(50, (int)busyLoad->percent);
+    TEST_ASSERT_LESS_THAN(10, (int)sleepyLoad->percent);
+    TEST_ASSERT_EQUAL_PTR(&report.tasks[0], busyLoad);
+    for (int i = 1; i < report.taskCount; i++)
+        TEST_ASSERT_TRUE(report.tasks[i - 1].percent >= report.tasks[i].percent);
+
+    TEST_ASSERT_EQUAL_INT(0, busyLoad->core);
+    // an unpinned thread only has one core to run on if the host has one
+    if (std::thread::hardware_concurrency() > 1)
+        TEST_ASSERT_EQUAL_INT(-1, sleepyLoad->core);
+    // woken about every 5 ms
+    TEST_ASSERT_GREATER_THAN(20, sleepyLoad->switches);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, busyLoad->switches);
+
+    TEST_ASSERT_GREATER_THAN(0, report.coreCount);
+    for (int core = 0; core < report.coreCount; core++)
+    {
+        // idle is counted in jiffies, so allow a little over
+        TEST_ASSERT_GREATER_OR_EQUAL(0, (int)report.idlePercent[core]);
+        TEST_ASSERT_LESS_OR_EQUAL(110, (int)report.idlePercent[core]);
+    }
+}
+
+// the window spans the last CPU_MONITOR_WINDOW_SAMPLES samples once the ring has wrapped
+static void test_window_slides()
+{
+    static CpuReport report;
+    const int samples = 3 * CPU_MONITOR_WINDOW_SAMPLES + 2;
+    std::chrono::steady_clock::time_point before[samples], after[samples];
+    for (int i = 0; i < samples; i++)
+    {
+        before[i] = std::chrono::steady_clock::now();
+        monitor->sample();
+        after[i] = std::chrono::steady_clock::now();
+        sleepMS(10 + i);
+    }
+
+    // the window is between the sample times, which fall somewhere in each sample() call
+    monitor->getReport(report);
+    const int last = samples - 1;
+    const int oldest = last - CPU_MONITOR_WINDOW_SAMPLES;
+    long shortest = std::chrono::duration_cast<std::chrono::microseconds>(before[last] - after[oldest]).count();
+    long longest = std::chrono::duration_cast<std::chrono::microseconds>(after[last] - before[oldest]).count();
+    TEST_ASSERT_GREATER_OR_EQUAL(shortest, (long)report.windowMicros);
+    TEST_ASSERT_LESS_OR_EQUAL(longest, (long)report.windowMicros);
+}
+
+// the sampling task samples while resumed, under its own name, and stops when paused
+static void test_sampling_task()
+{
+    static CpuReport report;
+    CpuMonitor *sampled = new CpuMonitor(20);
+    sampled->resume();
+    sleepMS(250);
+    sampled->getReport(report);
+    TEST_ASSERT_INT_WITHIN(30000, CPU_MONITOR_WINDOW_SAMPLES * 20000, report.windowMicros);
+    TEST_ASSERT_NOT_NULL(findTask(report, "CpuMonitor Task"));
+
+    sampled->pause();
+    sleepMS(100);
+    sampled->getReport(report);
+    uint32_t window = report.windowMicros;
+    sleepMS(200);
+    sampled->getReport(report);
+    TEST_ASSERT_EQUAL_UINT32(window, report.windowMicros);
+    delete sampled;
+}
+
+void setUp() { monitor = new CpuMonitor(); }
+void tearDown() { delete monitor; }
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_needs_two_samples);
+    RUN_TEST(test_busy_and_sleeping_tasks);
+    RUN_TEST(test_window_slides);
+    RUN_TEST(test_sampling_task);
+    return UNITY_END();
+}
@@ -0,0 +1,175 @@
+#include <unity.h>
+#include <chrono>
+#include "FastRandom.h"
+
+// the same seed gives the same sequence, and different seeds different ones
+static void test_seeded_sequences()
+{
+    FastRandom a(7), b(7), c(8);
+    int same = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        uint32_t value = a.next();
+        TEST_ASSERT_EQUAL_HEX32(value, b.next());
+        same += (value == c.next()) ? 1 : 0;
+    }
+    TEST_ASSERT_LESS_THAN(2, same);
+
+    a.seed(7);
+    FastRandom d(7);
+    TEST_ASSERT_EQUAL_HEX32(d.next(), a.next());
+}
+
+// a zero seed still gives a working generator
+static void test_zero_seed()
+{
+    FastRandom rng(0);
+    uint32_t ored = 0;
+    for (int i = 0; i < 16; i++)
+        ored |= rng.next();
+    TEST_ASSERT_NOT_EQUAL(0, ored);
+}
+
+// each of 32 bits is set about half the time
+static void test_bits_are_balanced()
+{
+    FastRandom rng(123);
+    const int draws = 100000;
+    int counts[32] = {0};
+    for (int i = 0; i < draws; i++)
+    {
+        uint32_t value = rng.next();
+        for (int bit = 0; bit < 32; bit++)
+            counts[bit] += (value >> bit) & 1;
+    }
+    for (int bit = 0; bit < 32; bit++)
+        TEST_ASSERT_INT_WITHIN(draws / 100, draws / 2, counts[bit]);
+}
+
+static void test_next_below()
+{
+    FastRandom rng(5);
+    const int bound = 10;
+    const int draws = 100000;
+    int counts[bound] = {0};
+    for (int i = 0; i < draws; i++)
+    {
+        uint32_t value = rng.nextBelow(bound);
+        TEST_ASSERT_LESS_THAN(bound, value);
+        counts[value]++;
+    }
+    for (int i = 0; i < bound; i++)
+        TEST_ASSERT_INT_WITHIN(draws / 100, draws / bound, counts[i]);
+    TEST_ASSERT_EQUAL_UINT32(0, rng.nextBelow(1));
+}
+
+static void test_probability()
+{
+    TEST_ASSERT_EQUAL_UINT16(0, FastRandom::probability(0, 1000));
+    TEST_ASSERT_EQUAL_UINT16(655, FastRandom::probability(10, 1000));
+    TEST_ASSERT_EQUAL_UINT16(32768, FastRandom::probability(1, 2));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, FastRandom::probability(1000, 1000));
+}
+
+// each lane is set if its own 16-bit number, built from the lane's bit of successive
+// words most significant first, is below the probability
+static void test_bernoulli_mask_matches_per_lane_compare()
+{
+    FastRandom rng(99);
+    const uint16_t probabilities[] = {1, 655, 4096, 20000, 32768, 50000, 65000, 0xFFFF};
+    for (uint16_t probability : probabilities)
+    {
+        for (int trial = 0; trial < 200; trial++)
+        {
+            // the mask draws the same words, it just stops once every lane is decided
+            FastRandom copy = rng;
+            uint32_t words[16];
+            for (int i = 0; i < 16; i++)
+                words[i] = copy.next();
+            uint32_t expected = 0;
+            for (int lane = 0; lane < 32; lane++)
+            {
+                uint32_t number = 0;
+                for (int i = 0; i < 16; i++)
+                    number = (number << 1) | ((words[i] >> lane) & 1);
+                if (number < probability)
+                    expected |= 1u << lane;
+            }
+            TEST_ASSERT_EQUAL_HEX32(expected, rng.bernoulliMask(probability));
+        }
+    }
+}
+
+static void test_bernoulli_mask_rates()
+{
+    FastRandom rng(42);
+    const uint16_t probabilities[] = {FastRandom::probability(10, 1000), FastRandom::probability(50, 1000),
+                                      FastRandom::probability(45, 100), FastRandom::probability(999, 1000)};
+    const long words = 100000;
+    for (uint16_t probability : probabilities)
+    {
+        long ones = 0;
+        for (long i = 0; i < words; i++)
+            ones += __builtin_popcount(rng.bernoulliMask(probability));
+        double expected = probability / 65536.0;
+        TEST_ASSERT_FLOAT_WITHIN(0.002, expected, ones / (32.0 * words));
+    }
+    for (int i = 0; i < 1000; i++)
+        TEST_ASSERT_EQUAL_HEX32(0, rng.bernoulliMask(0));
+}
+
+// only the lanes asked for are drawn
+static void test_bernoulli_mask_lanes()
+{
+    FastRandom rng(3);
+    const uint32_t lanes = 0x00F000F5;
+    long ones = 0;
+    const long words = 50000;
+    for (long i = 0; i < words; i++)
+    {
+        uint32_t mask = rng.bernoulliMask(FastRandom::probability(1, 2), lanes);
+        TEST_ASSERT_EQUAL_HEX32(0, mask & ~lanes);
+        ones += __builtin_popcount(mask);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.5, ones / ((double)__builtin_popcount(lanes) * words));
+    TEST_ASSERT_EQUAL_HEX32(0, rng.bernoulliMask(0xFFFF, 0));
+}
+
+// random bits per µs: 32 at a time from bernoulliMask(), one per random(0, 1000). not checked
+static void test_benchmark()
+{
+    FastRandom rng(1);
+    const int draws = 2000000;
+    volatile uint32_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < draws; i++)
+        sink = sink + rng.bernoulliMask(655);
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < draws; i++)
+        sink = sink + (random(0, 1000) < 10);
+    auto end = std::chrono::steady_clock::now();
+
+    char message[96];
+    snprintf(message, sizeof(message), "bernoulliMask %.0f bits/us, random() %.0f bits/us",
+             32.0 * draws / std::chrono::duration<double, std::micro>(middle - start).count(),
+             draws / std::chrono::duration<double, std::micro>(end - middle).count());
+    TEST_MESSAGE(message);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_seeded_sequences);
+    RUN_TEST(test_zero_seed);
+    RUN_TEST(test_bits_are_balanced);
+    RUN_TEST(test_next_below);
+    RUN_TEST(test_probability);
+    RUN_TEST(test_bernoulli_mask_matches_per_lane_compare);
+    RUN_TEST(test_bernoulli_mask_rates);
+    RUN_TEST(test_bernoulli_mask_lanes);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
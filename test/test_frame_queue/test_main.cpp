@@ -0,0 +1,196 @@
+#include <unity.h>
+#include <thread>
+#include "FrameQueue.h"
+
+static FrameQueue *queue;
+
+// fill a slot with a frame number, so the consumer can tell frames apart and spot torn ones
+static bool produce(uint16_t number, uint32_t generation)
+{
+    QueuedFrame *slot = queue->beginWrite();
+    if (slot == nullptr)
+        return false;
+    static FrameBuffer frame;
+    frame.fill(number);
+    slot->write(FrameView(&frame));
+    queue->commitWrite(generation);
+    return true;
+}
+
+static void test_empty_queue_has_nothing_to_show()
+{
+    bool isNew = true;
+    TEST_ASSERT_NULL(queue->nextFrame(1, &isNew));
+    TEST_ASSERT_FALSE(isNew);
+    TEST_ASSERT_EQUAL_INT(0, queue->getDepth());
+    TEST_ASSERT_EQUAL_UINT32(1, queue->getConsumerStalls());
+}
+
+// the frame on show stays until the next is committed
+static void test_keeps_showing_the_last_frame()
+{
+    TEST_ASSERT_TRUE(produce(10, 1));
+    bool isNew = false;
+    const QueuedFrame *frame = queue->nextFrame(1, &isNew);
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_TRUE(isNew);
+    TEST_ASSERT_EQUAL_HEX16(10, frame->colors.at(0, 0));
+
+    TEST_ASSERT_EQUAL_PTR(frame, queue->nextFrame(1, &isNew));
+    TEST_ASSERT_FALSE(isNew);
+    TEST_ASSERT_EQUAL_HEX16(10, frame->colors.at(63, 31));
+}
+
+// frames are shown in order, one per nextFrame(), none skipped
+static void test_frames_in_order()
+{
+    for (uint16_t number = 1; number <= 2; number++)
+        TEST_ASSERT_TRUE(produce(number, 1));
+    TEST_ASSERT_EQUAL_INT(2, queue->getDepth());
+    for (uint16_t number = 1; number <= 2; number++)
+    {
+        const QueuedFrame *frame = queue->nextFrame(1);
+        TEST_ASSERT_EQUAL_HEX16(number, frame->colors.at(5, 5));
+    }
+    TEST_ASSERT_EQUAL_INT(0, queue->getDepth());
+}
+
+// the frame on show keeps its slot, so SLOTS - 1 frames fit ahead of it
+static void test_full_queue_stalls_the_producer()
+{
+    TEST_ASSERT_TRUE(produce(1, 1));
+    queue->nextFrame(1);
+    for (int i = 0; i < FrameQueue::SLOTS - 1; i++)
+        TEST_ASSERT_TRUE(produce(2 + i, 1));
+    TEST_ASSERT_FALSE(produce(99, 1));
+    TEST_ASSERT_EQUAL_UINT32(1, queue->getProducerStalls());
+
+    // showing the next frame frees the slot of the one before
+    queue->nextFrame(1);
+    TEST_ASSERT_TRUE(produce(99, 1));
+}
+
+// frames of another generation, e.g. from a matrix switched out, are dropped
+static void test_old_generations_are_dropped()
+{
+    TEST_ASSERT_TRUE(produce(1, 1));
+    TEST_ASSERT_TRUE(produce(2, 1));
+    TEST_ASSERT_TRUE(produce(3, 2));
+    bool isNew = false;
+    const QueuedFrame *frame = queue->nextFrame(2, &isNew);
+    TEST_ASSERT_TRUE(isNew);
+    TEST_ASSERT_EQUAL_HEX16(3, frame->colors.at(0, 0));
+    TEST_ASSERT_EQUAL_INT(0, queue->getDepth());
+
+    // nothing of the new generation yet
+    TEST_ASSERT_TRUE(produce(4, 2));
+    TEST_ASSERT_TRUE(produce(5, 2));
+    TEST_ASSERT_NULL(queue->nextFrame(3, &isNew));
+    TEST_ASSERT_FALSE(isNew);
+}
+
+// indexed frames are queued as their indices and a copy of the palette, so they keep their
+// colours when the matrix changes its palette, and look up black while there's none
+static void test_indexed_frames_keep_their_palette()
+{
+    static IndexFrameBuffer indices;
+    uint16_t palette[FrameView::PALETTE_SIZE];
+    for (int i = 0; i < FrameView::PALETTE_SIZE; i++)
+        palette[i] = (uint16_t)(i * 3);
+    for (int y = 0; y < FrameBuffer::HEIGHT; y++)
+        for (int x = 0; x < FrameBuffer::WIDTH; x++)
+            indices.at(x, y) = (uint8_t)(x + y);
+
+    queue->beginWrite()->write(FrameView(&indices, palette));
+    queue->commitWrite(1);
+    queue->beginWrite()->write(FrameView(&indices, nullptr));
+    queue->commitWrite(1);
+    palette[40] = 0xFFFF;
+    indices.at(10, 30) = 0;
+
+    const QueuedFrame *frame = queue->nextFrame(1);
+    FrameView view = frame->view();
+    TEST_ASSERT_EQUAL_INT(FRAME_FORMAT_INDEXED8, view.format);
+    TEST_ASSERT_NOT_NULL(view.palette);
+    uint16_t colors[FrameBuffer::WIDTH];
+    view.readRow(30, colors);
+    for (int x = 0; x < FrameBuffer::WIDTH; x++)
+        TEST_ASSERT_EQUAL_HEX16((uint16_t)(((x + 30) & 0xFF) * 3), colors[x]);
+
+    view = queue->nextFrame(1)->view();
+    TEST_ASSERT_EQUAL_INT(FRAME_FORMAT_INDEXED8, view.format);
+    TEST_ASSERT_NULL(view.palette);
+    view.readRow(0, colors);
+    TEST_ASSERT_EQUAL_HEX16(0, colors[7]);
+
+    // and the slots take RGB565 frames again after
+    TEST_ASSERT_TRUE(produce(6, 1));
+    view = queue->nextFrame(1)->view();
+    TEST_ASSERT_EQUAL_INT(FRAME_FORMAT_RGB565, view.format);
+    TEST_ASSERT_EQUAL_HEX16(6, view.colors->at(3, 3));
+}
+
+// a producer and a consumer thread at full speed: every frame arrives once, in order,
+// and whole, while the producer keeps writing the other slots
+static void test_threads_stress()
+{
+    const uint32_t frames = 200000;
+    std::thread producer([frames]() {
+        for (uint32_t number = 1; number <= frames;)
+        {
+            QueuedFrame *slot = queue->beginWrite();
+            if (slot == nullptr)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            slot->format = FRAME_FORMAT_RGB565;
+            slot->colors.fill((uint16_t)number);
+            queue->commitWrite(1);
+            number++;
+        }
+    });
+
+    uint32_t expected = 1;
+    uint32_t torn = 0;
+    uint32_t outOfOrder = 0;
+    while (expected <= frames)
+    {
+        bool isNew = false;
+        const QueuedFrame *frame = queue->nextFrame(1, &isNew);
+        if (!isNew)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        uint16_t number = frame->colors.at(0, 0);
+        if (number != (uint16_t)expected)
+            outOfOrder++;
+        for (int y = 0; y < FrameBuffer::HEIGHT; y += 7)
+        {
+            if (frame->colors.at(FrameBuffer::WIDTH - 1, y) != number)
+                torn++;
+        }
+        expected++;
+    }
+    producer.join();
+    TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_INT(0, queue->getDepth());
+}
+
+void setUp() { queue = new FrameQueue(); }
+void tearDown() { delete queue; }
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_queue_has_nothing_to_show);
+    RUN_TEST(test_keeps_showing_the_last_frame);
+    RUN_TEST(test_frames_in_order);
+    RUN_TEST(test_full_queue_stalls_the_producer);
+    RUN_TEST(test_old_generations_are_dropped);
+    RUN_TEST(test_indexed_frames_keep_their_palette);
+    RUN_TEST(test_threads_stress);
+    return UNITY_END();
+}
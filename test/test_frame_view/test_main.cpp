@@ -0,0 +1,171 @@
+#include <unity.h>
+#include <chrono>
+#include "Matrix.h"
+
+// Matrix::getFrame() against the per-pixel getCellColor() it replaces, for both frame
+// formats, and the panel draw loop timed each way
+
+static const int W = Matrix::MATRIX_ARRAY_WIDTH;
+static const int H = Matrix::MATRIX_ARRAY_HEIGHT;
+
+// RGB565 frames of random colours
+class ColorMatrix : public Matrix
+{
+public:
+    ColorMatrix() { setSeed(1); }
+    void initialise() override {}
+    void calcNewStates() override
+    {
+        std::swap(bufferPrimary, bufferSecondary);
+        for (int y = 0; y < H; y++)
+            for (int x = 0; x < W; x++)
+                bufferPrimary->at(x, y) = (uint16_t)rng.next();
+    }
+};
+
+// indexed frames of random indices, into a palette that's only set when asked
+class IndexedMatrix : public Matrix
+{
+public:
+    IndexedMatrix() : Matrix(FRAME_FORMAT_INDEXED8)
+    {
+        setSeed(2);
+        for (int i = 0; i < 256; i++)
+            palette[i] = (uint16_t)(i * 257 + 1);
+    }
+    void initialise() override {}
+    void calcNewStates() override
+    {
+        for (int y = 0; y < H; y++)
+            for (int x = 0; x < W; x++)
+                indexPrimary->at(x, y) = (uint8_t)rng.next();
+    }
+    void usePalette() { framePalette = palette; }
+
+private:
+    uint16_t palette[256];
+};
+
+// the frame as getCellColor() reads it, the way the driver used to draw it to the panel
+static void drawCellsPerPixel(Matrix &matrix, FrameBuffer &panel)
+{
+    for (int x = 0; x < W; x++)
+        for (int y = 0; y < H; y++)
+            panel.at(x, y) = matrix.getCellColor(x, y);
+}
+
+// the frame a row at a time through its view
+static void drawCellsByRow(Matrix &matrix, FrameBuffer &panel)
+{
+    FrameView frame = matrix.getFrame();
+    for (int y = 0; y < H; y++)
+        frame.readRow(y, panel.row(y));
+}
+
+static void assertFramesEqual(const FrameBuffer &expected, const FrameBuffer &actual)
+{
+    for (int y = 0; y < H; y++)
+        TEST_ASSERT_EQUAL_HEX16_ARRAY(expected.row(y), actual.row(y), W);
+}
+
+static void test_rgb565_view()
+{
+    ColorMatrix matrix;
+    static FrameBuffer expected, actual;
+    for (int frame = 0; frame < 3; frame++)
+    {
+        matrix.calcNewStates();
+        FrameView view = matrix.getFrame();
+        TEST_ASSERT_EQUAL_INT(FRAME_FORMAT_RGB565, view.format);
+        TEST_ASSERT_NOT_NULL(view.colors);
+        drawCellsPerPixel(matrix, expected);
+        drawCellsByRow(matrix, actual);
+        assertFramesEqual(expected, actual);
+    }
+}
+
+// black until the palette is set, then the indices' colours
+static void test_indexed_view()
+{
+    IndexedMatrix matrix;
+    static FrameBuffer expected, actual;
+    matrix.calcNewStates();
+    FrameView view = matrix.getFrame();
+    TEST_ASSERT_EQUAL_INT(FRAME_FORMAT_INDEXED8, view.format);
+    TEST_ASSERT_NULL(view.palette);
+    actual.fill(0xFFFF);
+    drawCellsByRow(matrix, actual);
+    expected.fill(0);
+    assertFramesEqual(expected, actual);
+
+    matrix.usePalette();
+    for (int frame = 0; frame < 3; frame++)
+    {
+        matrix.calcNewStates();
+        drawCellsPerPixel(matrix, expected);
+        drawCellsByRow(matrix, actual);
+        assertFramesEqual(expected, actual);
+    }
+}
+
+// spans start and end anywhere in a row
+static void test_spans()
+{
+    IndexedMatrix matrix;
+    matrix.usePalette();
+    matrix.calcNewStates();
+    FrameView view = matrix.getFrame();
+    uint16_t colors[W + 1];
+    for (int x = 0; x < W; x += 7)
+    {
+        colors[W - x] = 0x1234;
+        view.readSpan(x, 5, W - x, colors);
+        for (int i = 0; i < W - x; i++)
+            TEST_ASSERT_EQUAL_HEX16(matrix.getCellColor(x + i, 5), colors[i]);
+        TEST_ASSERT_EQUAL_HEX16(0x1234, colors[W - x]);
+    }
+}
+
+// time to draw a frame per pixel and by row, for comparison. not checked
+static void benchmark(Matrix &matrix, const char *name)
+{
+    static FrameBuffer panel;
+    const int frames = 20000;
+    matrix.calcNewStates();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++)
+        drawCellsPerPixel(matrix, panel);
+    auto middle = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++)
+        drawCellsByRow(matrix, panel);
+    auto end = std::chrono::steady_clock::now();
+
+    char message[96];
+    snprintf(message, sizeof(message), "%s: per pixel %.2f us/frame, by row %.2f us/frame", name,
+             std::chrono::duration<double, std::micro>(middle - start).count() / frames,
+             std::chrono::duration<double, std::micro>(end - middle).count() / frames);
+    TEST_MESSAGE(message);
+}
+
+static void test_benchmark()
+{
+    ColorMatrix colorMatrix;
+    IndexedMatrix indexedMatrix;
+    indexedMatrix.usePalette();
+    benchmark(colorMatrix, "RGB565");
+    benchmark(indexedMatrix, "Indexed");
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rgb565_view);
+    RUN_TEST(test_indexed_view);
+    RUN_TEST(test_spans);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
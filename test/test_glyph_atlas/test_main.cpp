@@ -0,0 +1,246 @@
+#include <unity.h>
+#include "GlyphAtlas.h"
+#include "TextMask.h"
+#include "fonts/Led_Matrix_Font_5x3.h"
+#include "fonts/Matrix7x5.h"
+#include "fonts/Roboto_Black_20.h"
+#include "fonts/Roboto_Black_22.h"
+
+// GlyphAtlas and TextMask against Adafruit GFX drawing and measuring the same text
+
+static const GFXfont *const FONTS[] = {&Led_Matrix_Font_5x3, &Matrix7x5, &Roboto_Black_20, &Roboto_Black_22};
+static const int FONT_COUNT = sizeof(FONTS) / sizeof(FONTS[0]);
+
+// the glyphs of every font, all 95 printable characters at most
+static FixedGlyphAtlas<95> atlases[FONT_COUNT];
+
+// texts with digits, symbols, letters, line breaks, characters outside the fonts,
+// and lines long enough to wrap at the panel edge
+static const char *const TEXTS[] = {
+    "",
+    "42",
+    "21.5*",
+    "-3.7%",
+    "12:34",
+    "/0189",
+    "Hello, World!",
+    "  spaced  ",
+    "0123456789012345678901234",
+    "gjpqy|",
+    "a\nbc",
+    "\n1",
+    "1\n\n22",
+    "\x01\x7F\xC3\xA9",
+    "x\x80y",
+};
+
+struct Position
+{
+    int16_t x, y;
+};
+
+static const Position POSITIONS[] = {{0, 0}, {0, 20}, {10, 20}, {-5, 3}, {-40, 15}, {60, 31}, {30, 40}};
+
+// a GFX target recording the pixels drawn, clipped to its size
+class Canvas : public Adafruit_GFX
+{
+public:
+    static const int MAX_WIDTH = 96;
+    static const int MAX_HEIGHT = 64;
+    bool pixels[MAX_WIDTH][MAX_HEIGHT];
+
+    Canvas(int16_t w, int16_t h) : Adafruit_GFX(w, h) { clear(); }
+
+    void clear() { memset(pixels, 0, sizeof(pixels)); }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t) override
+    {
+        if (x >= 0 && x < width() && y >= 0 && y < height())
+            pixels[x][y] = true;
+    }
+};
+
+static void setUpAtlases()
+{
+    for (int font = 0; font < FONT_COUNT; font++)
+        TEST_ASSERT_TRUE(atlases[font].build(FONTS[font]));
+}
+
+// each glyph's rows are its bitmap, as drawChar() draws it
+static void test_glyph_rows_match_font()
+{
+    setUpAtlases();
+    static Canvas canvas(Canvas::MAX_WIDTH, Canvas::MAX_HEIGHT);
+    const int16_t cursorX = 20, cursorY = 40;
+    for (int font = 0; font < FONT_COUNT; font++)
+    {
+        const GFXfont *gfxFont = FONTS[font];
+        const GlyphAtlas &atlas = atlases[font];
+        TEST_ASSERT_EQUAL_PTR(gfxFont, atlas.getFont());
+        TEST_ASSERT_EQUAL_UINT8(gfxFont->yAdvance, atlas.getYAdvance());
+        canvas.setFont(gfxFont);
+        for (int c = 0; c < 256; c++)
+        {
+            const GlyphAtlas::Glyph *glyph = atlas.find(c);
+            if (c < gfxFont->first || c > gfxFont->last)
+            {
+                TEST_ASSERT_NULL(glyph);
+                continue;
+            }
+            TEST_ASSERT_NOT_NULL(glyph);
+            const GFXglyph &fontGlyph = gfxFont->glyph[c - gfxFont->first];
+            TEST_ASSERT_EQUAL_UINT8(fontGlyph.width, glyph->width);
+            TEST_ASSERT_EQUAL_UINT8(fontGlyph.height, glyph->height);
+            TEST_ASSERT_EQUAL_UINT8(fontGlyph.xAdvance, glyph->xAdvance);
+            TEST_ASSERT_EQUAL_INT8(fontGlyph.xOffset, glyph->xOffset);
+            TEST_ASSERT_EQUAL_INT8(fontGlyph.yOffset, glyph->yOffset);
+
+            canvas.clear();
+            canvas.drawChar(cursorX, cursorY, c, 1, 0, 1);
+            int drawn = 0;
+            for (int x = 0; x < Canvas::MAX_WIDTH; x++)
+                for (int y = 0; y < Canvas::MAX_HEIGHT; y++)
+                    drawn += canvas.pixels[x][y] ? 1 : 0;
+            int set = 0;
+            const uint32_t *rows = atlas.getRows(*glyph);
+            for (int row = 0; row < glyph->height; row++)
+            {
+                set += __builtin_popcount(rows[row]);
+                for (int column = 0; column < glyph->width; column++)
+                {
+                    bool pixel = canvas.pixels[cursorX + glyph->xOffset + column][cursorY + glyph->yOffset + row];
+                    TEST_ASSERT_EQUAL((rows[row] >> column) & 1, pixel ? 1 : 0);
+                }
+            }
+            TEST_ASSERT_EQUAL_INT(drawn, set);
+        }
+    }
+}
+
+static void checkBounds(const GlyphAtlas &atlas, const GFXfont *font, const char *atlasText, const char *gfxText)
+{
+    static Canvas canvas(TextMask::WIDTH, TextMask::HEIGHT);
+    canvas.setFont(font);
+    for (const Position &position : POSITIONS)
+    {
+        int16_t x1, y1, gfxX1, gfxY1;
+        uint16_t w, h, gfxW, gfxH;
+        atlas.getTextBounds(atlasText, position.x, position.y, &x1, &y1, &w, &h);
+        canvas.getTextBounds(gfxText, position.x, position.y, &gfxX1, &gfxY1, &gfxW, &gfxH);
+        char message[96];
+        snprintf(message, sizeof(message), "\"%s\" at (%d,%d)", gfxText, position.x, position.y);
+        TEST_ASSERT_EQUAL_INT16_MESSAGE(gfxX1, x1, message);
+        TEST_ASSERT_EQUAL_INT16_MESSAGE(gfxY1, y1, message);
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(gfxW, w, message);
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(gfxH, h, message);
+        if (position.x == 0 && position.y == 0)
+        {
+            TEST_ASSERT_EQUAL_INT_MESSAGE(gfxW, atlas.getTextWidth(atlasText), message);
+            TEST_ASSERT_EQUAL_INT_MESSAGE(gfxH, atlas.getTextHeight(atlasText), message);
+        }
+    }
+}
+
+// text is measured as getTextBounds() measures it, wrapping included
+static void test_bounds_match_gfx()
+{
+    setUpAtlases();
+    for (int font = 0; font < FONT_COUNT; font++)
+    {
+        for (const char *text : TEXTS)
+            checkBounds(atlases[font], FONTS[font], text, text);
+    }
+}
+
+// characters outside the charset are skipped, as GFX skips those outside the font
+static void test_charset_skips_other_characters()
+{
+    FixedGlyphAtlas<GlyphAtlas::charsetSize("0123456789")> digits;
+    TEST_ASSERT_TRUE(digits.build(&Roboto_Black_22, "0123456789"));
+    TEST_ASSERT_NULL(digits.find('.'));
+    TEST_ASSERT_NOT_NULL(digits.find('7'));
+    checkBounds(digits, &Roboto_Black_22, "21.5*", "215");
+    checkBounds(digits, &Roboto_Black_22, "x9\ny8", "9\n8");
+
+    // repeated characters are decoded once
+    FixedGlyphAtlas<2> two;
+    TEST_ASSERT_TRUE(two.build(&Matrix7x5, "1212211"));
+    int rows = two.find('1')->height + two.find('2')->height;
+    TEST_ASSERT_EQUAL_INT(2 * sizeof(GlyphAtlas::Glyph) + rows * sizeof(uint32_t), two.getUsedBytes());
+}
+
+// an atlas too small for the charset fails to build
+static void test_atlas_overflow()
+{
+    FixedGlyphAtlas<3> small;
+    TEST_ASSERT_FALSE(small.build(&Matrix7x5, "0123"));
+    FixedGlyphAtlas<4, 10> shortRows;
+    TEST_ASSERT_FALSE(shortRows.build(&Matrix7x5, "0123"));
+    TEST_ASSERT_FALSE(shortRows.build(nullptr, "0"));
+}
+
+// a rendered mask has exactly the pixels print() draws on the panel, and their bounding box
+static void test_render_matches_print()
+{
+    setUpAtlases();
+    static Canvas canvas(TextMask::WIDTH, TextMask::HEIGHT);
+    static TextMask mask;
+    for (int font = 0; font < FONT_COUNT; font++)
+    {
+        canvas.setFont(FONTS[font]);
+        for (const char *text : TEXTS)
+        {
+            for (const Position &position : POSITIONS)
+            {
+                canvas.clear();
+                canvas.setCursor(position.x, position.y);
+                canvas.print(text);
+                mask.render(text, atlases[font], position.x, position.y);
+
+                char message[96];
+                snprintf(message, sizeof(message), "font %d \"%s\" at (%d,%d)", font, text, position.x, position.y);
+                int left = TextMask::WIDTH, right = -1, top = TextMask::HEIGHT, bottom = -1;
+                for (int y = 0; y < TextMask::HEIGHT; y++)
+                {
+                    uint64_t expected = 0;
+                    for (int x = 0; x < TextMask::WIDTH; x++)
+                    {
+                        if (!canvas.pixels[x][y])
+                            continue;
+                        expected |= (uint64_t)1 << x;
+                        left = std::min(left, x);
+                        right = std::max(right, x);
+                        top = std::min(top, y);
+                        bottom = std::max(bottom, y);
+                    }
+                    TEST_ASSERT_EQUAL_HEX64_MESSAGE(expected, mask.getRow(y), message);
+                }
+                TEST_ASSERT_EQUAL_INT_MESSAGE(bottom < top, mask.isEmpty(), message);
+                if (!mask.isEmpty())
+                {
+                    TEST_ASSERT_EQUAL_INT_MESSAGE(left, mask.getLeft(), message);
+                    TEST_ASSERT_EQUAL_INT_MESSAGE(right, mask.getRight(), message);
+                    TEST_ASSERT_EQUAL_INT_MESSAGE(top, mask.getTop(), message);
+                    TEST_ASSERT_EQUAL_INT_MESSAGE(bottom, mask.getBottom(), message);
+                }
+            }
+        }
+    }
+
+    mask.render(nullptr, atlases[0], 0, 0);
+    TEST_ASSERT_TRUE(mask.isEmpty());
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_glyph_rows_match_font);
+    RUN_TEST(test_bounds_match_gfx);
+    RUN_TEST(test_charset_skips_other_characters);
+    RUN_TEST(test_atlas_overflow);
+    RUN_TEST(test_render_matches_print);
+    return UNITY_END();
+}
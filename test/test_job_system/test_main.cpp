@@ -0,0 +1,168 @@
+#include <unity.h>
+#include <chrono>
+#include <thread>
+#include "JobSystem.h"
+#include "LifeBoard.h"
+
+// counts how many times each job ran
+struct CountingJobs
+{
+    std::atomic<int> runs[JOB_SYSTEM_MAX_JOBS + 8];
+
+    CountingJobs()
+    {
+        for (std::atomic<int> &count : runs)
+            count.store(0);
+    }
+
+    static void job(void *context, int job)
+    {
+        static_cast<CountingJobs *>(context)->runs[job].fetch_add(1);
+    }
+};
+
+// every job of every batch runs exactly once, whatever the batch size and worker count
+static void test_every_job_runs_once()
+{
+    for (int workers = 0; workers <= JOB_SYSTEM_MAX_WORKERS; workers++)
+    {
+        for (int stealing = 0; stealing <= 1; stealing++)
+        {
+            JobSystem jobs(workers, 0, stealing);
+            TEST_ASSERT_EQUAL_INT(workers, jobs.getWorkerCount());
+            for (int jobCount = 0; jobCount <= JOB_SYSTEM_MAX_JOBS + 1; jobCount++)
+            {
+                CountingJobs counts;
+                jobs.run(jobCount, CountingJobs::job, &counts);
+                for (int job = 0; job < jobCount; job++)
+                    TEST_ASSERT_EQUAL_INT(1, counts.runs[job].load());
+                TEST_ASSERT_EQUAL_INT(0, counts.runs[jobCount].load());
+            }
+        }
+    }
+}
+
+// one generation of a LifeBoard, a band per job, each band with its own rng
+struct LifeJobs
+{
+    const LifeBoard *current;
+    LifeBoard *next;
+    const LifeRule *rule;
+    FastRandom rngs[LifeBoard::BANDS];
+
+    static void job(void *context, int band)
+    {
+        LifeJobs *jobs = static_cast<LifeJobs *>(context);
+        jobs->next->calcGenerationBand<WrappedEdges>(band, *jobs->current, *jobs->rule, jobs->rngs[band]);
+    }
+};
+
+// run generations of a chance-based rule, return a hash of every board
+static uint64_t runLife(JobSystem *jobs, int generations)
+{
+    LifeRule rule(LIFE_RULE_HIGHLIFE);
+    rule.setSurvivalChance(0, 1, 20);
+    LifeBoard boards[2];
+    FastRandom fill(11);
+    for (int x = 0; x < LifeBoard::WIDTH; x++)
+        boards[0].setColumn(x, fill.next() & fill.next());
+
+    LifeJobs life;
+    life.rule = &rule;
+    for (int band = 0; band < LifeBoard::BANDS; band++)
+        life.rngs[band].seed(100 + band);
+
+    uint64_t hash = 1469598103934665603ull;
+    for (int generation = 0; generation < generations; generation++)
+    {
+        life.current = &boards[generation & 1];
+        life.next = &boards[(generation + 1) & 1];
+        life.next->beginGeneration<WrappedEdges>(*life.current);
+        if (jobs != nullptr)
+            jobs->run(LifeBoard::BANDS, LifeJobs::job, &life);
+        else
+            for (int band = 0; band < LifeBoard::BANDS; band++)
+                LifeJobs::job(&life, band);
+        life.next->endGeneration();
+        for (int x = 0; x < LifeBoard::WIDTH; x++)
+            hash = (hash ^ life.next->getColumn(x)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// the result doesn't depend on how many cores ran the jobs, or which
+static void test_identical_output()
+{
+    uint64_t expected = runLife(nullptr, 500);
+    for (int workers = 0; workers <= JOB_SYSTEM_MAX_WORKERS; workers++)
+    {
+        for (int stealing = 0; stealing <= 1; stealing++)
+        {
+            JobSystem jobs(workers, 0, stealing);
+            TEST_ASSERT_EQUAL_HEX64(expected, runLife(&jobs, 500));
+        }
+    }
+}
+
+static void slowFirstJob(void *context, int job)
+{
+    if (job == 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    static_cast<std::atomic<int> *>(context)->fetch_add(1);
+}
+
+// while the caller is stuck on a slow job, a worker takes the rest of its share
+static void test_work_stealing()
+{
+    std::atomic<int> done(0);
+    JobSystem stealing(1, 0, true);
+    stealing.run(16, slowFirstJob, &done);
+    TEST_ASSERT_EQUAL_INT(16, done.load());
+    TEST_ASSERT_GREATER_THAN(0, stealing.getStolenJobs());
+
+    done.store(0);
+    JobSystem notStealing(1, 0, false);
+    notStealing.run(16, slowFirstJob, &done);
+    TEST_ASSERT_EQUAL_INT(16, done.load());
+    TEST_ASSERT_EQUAL_UINT32(0, notStealing.getStolenJobs());
+}
+
+static void spinJob(void *context, int job)
+{
+    volatile uint32_t x = job;
+    for (int i = 0; i < 20000; i++)
+        x = x * 1664525u + 1013904223u;
+}
+
+// time for a batch of 8 busy jobs by worker count, for comparison. not checked,
+// it depends on the host's cores
+static void test_scaling()
+{
+    char message[160];
+    int length = snprintf(message, sizeof(message), "%u host cores, us/batch by workers:",
+                          std::thread::hardware_concurrency());
+    for (int workers = 0; workers <= 3; workers++)
+    {
+        JobSystem jobs(workers, 0);
+        const int batches = 200;
+        auto start = std::chrono::steady_clock::now();
+        for (int batch = 0; batch < batches; batch++)
+            jobs.run(8, spinJob, nullptr);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / batches;
+        length += snprintf(message + length, sizeof(message) - length, " %d: %.0f", workers, us);
+    }
+    TEST_MESSAGE(message);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_every_job_runs_once);
+    RUN_TEST(test_identical_output);
+    RUN_TEST(test_work_stealing);
+    RUN_TEST(test_scaling);
+    return UNITY_END();
+}
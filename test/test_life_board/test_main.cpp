@@ -0,0 +1,314 @@
+#include <unity.h>
+#include <chrono>
+#include "LifeBoard.h"
+
+// LifeBoard against a plain per-cell Game of Life, generation by generation
+
+static const int W = LifeBoard::WIDTH;
+static const int H = LifeBoard::HEIGHT;
+
+// one generation per cell: count the 8 neighbours, then look the outcome up in the rule
+struct ReferenceBoard
+{
+    bool cells[W][H];
+
+    int countNeighbours(int x, int y, bool wrap) const
+    {
+        int count = 0;
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                if (dx == 0 && dy == 0)
+                    continue;
+                int nx = x + dx;
+                int ny = y + dy;
+                if (wrap)
+                {
+                    nx = (nx + W) % W;
+                    ny = (ny + H) % H;
+                }
+                else if (nx < 0 || nx >= W || ny < 0 || ny >= H)
+                {
+                    continue;
+                }
+                count += cells[nx][ny] ? 1 : 0;
+            }
+        }
+        return count;
+    }
+
+    // the chance (0-1000) of each cell being alive next generation
+    void calcTransitions(const LifeRule &rule, bool wrap, uint16_t transitions[W][H]) const
+    {
+        for (int x = 0; x < W; x++)
+        {
+            for (int y = 0; y < H; y++)
+            {
+                transitions[x][y] = rule.getTransition(cells[x][y], countNeighbours(x, y, wrap));
+            }
+        }
+    }
+
+    // the next generation of a rule without chances
+    void step(const LifeRule &rule, bool wrap)
+    {
+        static uint16_t transitions[W][H];
+        calcTransitions(rule, wrap, transitions);
+        for (int x = 0; x < W; x++)
+        {
+            for (int y = 0; y < H; y++)
+            {
+                cells[x][y] = transitions[x][y] == LifeRule::CERTAIN;
+            }
+        }
+    }
+};
+
+static void randomFill(ReferenceBoard &reference, LifeBoard &board, uint32_t seed, int percentAlive)
+{
+    FastRandom rng(seed);
+    for (int x = 0; x < W; x++)
+    {
+        for (int y = 0; y < H; y++)
+        {
+            reference.cells[x][y] = rng.nextBelow(100) < (uint32_t)percentAlive;
+            board.setCell(x, y, reference.cells[x][y]);
+        }
+    }
+}
+
+static int countDifferences(const ReferenceBoard &reference, const LifeBoard &board)
+{
+    int differences = 0;
+    for (int x = 0; x < W; x++)
+    {
+        for (int y = 0; y < H; y++)
+        {
+            differences += (reference.cells[x][y] != board.getCell(x, y)) ? 1 : 0;
+        }
+    }
+    return differences;
+}
+
+template <class EdgePolicy>
+static void checkAgainstReference(const char *ruleString, int generations)
+{
+    LifeRule rule(ruleString);
+    TEST_ASSERT_EQUAL_STRING(ruleString, rule.getRuleString());
+    static ReferenceBoard reference;
+    LifeBoard current, next;
+    FastRandom rng(1);
+    randomFill(reference, current, 1234, 40);
+
+    for (int generation = 0; generation < generations; generation++)
+    {
+        reference.step(rule, EdgePolicy::WRAP);
+        next.calcNextGeneration<EdgePolicy>(current, rule, rng);
+        std::swap(current, next);
+        char message[64];
+        snprintf(message, sizeof(message), "%s generation %d", ruleString, generation);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, countDifferences(reference, current), message);
+    }
+}
+
+// every specialised kernel, and the generic one
+static void test_conway_matches_reference()
+{
+    checkAgainstReference<WrappedEdges>(LIFE_RULE_CONWAY, 300);
+    checkAgainstReference<DeadEdges>(LIFE_RULE_CONWAY, 300);
+}
+
+static void test_highlife_matches_reference()
+{
+    checkAgainstReference<WrappedEdges>(LIFE_RULE_HIGHLIFE, 300);
+    checkAgainstReference<DeadEdges>(LIFE_RULE_HIGHLIFE, 300);
+}
+
+static void test_day_and_night_matches_reference()
+{
+    checkAgainstReference<WrappedEdges>(LIFE_RULE_DAY_AND_NIGHT, 300);
+    checkAgainstReference<DeadEdges>(LIFE_RULE_DAY_AND_NIGHT, 300);
+}
+
+static void test_seeds_matches_reference()
+{
+    checkAgainstReference<WrappedEdges>(LIFE_RULE_SEEDS, 100);
+    checkAgainstReference<DeadEdges>(LIFE_RULE_SEEDS, 100);
+}
+
+static void test_generic_rule_matches_reference()
+{
+    checkAgainstReference<WrappedEdges>("B36/S125", 300);
+    checkAgainstReference<DeadEdges>("B0/S8", 50);
+}
+
+// bands write only their own columns, so the order they run in doesn't matter
+static void test_bands_in_any_order()
+{
+    LifeRule rule(LIFE_RULE_HIGHLIFE);
+    static ReferenceBoard reference;
+    LifeBoard current, forwards, backwards;
+    FastRandom rng(1);
+    randomFill(reference, current, 99, 35);
+
+    for (int generation = 0; generation < 100; generation++)
+    {
+        forwards.calcNextGeneration<WrappedEdges>(current, rule, rng);
+        backwards.beginGeneration<WrappedEdges>(current);
+        for (int band = LifeBoard::BANDS - 1; band >= 0; band--)
+        {
+            backwards.calcGenerationBand<WrappedEdges>(band, current, rule, rng);
+        }
+        backwards.endGeneration();
+        for (int x = 0; x < W; x++)
+        {
+            TEST_ASSERT_EQUAL_HEX32(forwards.getColumn(x), backwards.getColumn(x));
+        }
+        TEST_ASSERT_EQUAL_HEX32(forwards.getChangedTiles(), backwards.getChangedTiles());
+        current = forwards;
+    }
+}
+
+// with chances, cells the rule decides for certain must match the reference, and the
+// others must come out alive about as often as their chance says
+static void test_chances_follow_transition_table()
+{
+    LifeRule rule(LIFE_RULE_CONWAY);
+    rule.setSurvivalChance(0, 1, 100); // 10%
+    rule.setSurvivalChance(4, 5, 500); // 50%
+    rule.setBirthChance(6, 6, 250);    // 25%
+    static ReferenceBoard reference;
+    static uint16_t transitions[W][H];
+    LifeBoard current, next;
+    FastRandom rng(42);
+    randomFill(reference, current, 7, 40);
+
+    long drawn[LifeRule::CERTAIN + 1] = {0};
+    long alive[LifeRule::CERTAIN + 1] = {0};
+    for (int generation = 0; generation < 400; generation++)
+    {
+        reference.calcTransitions(rule, true, transitions);
+        next.calcNextGeneration<WrappedEdges>(current, rule, rng);
+        for (int x = 0; x < W; x++)
+        {
+            for (int y = 0; y < H; y++)
+            {
+                uint16_t chance = transitions[x][y];
+                bool cell = next.getCell(x, y);
+                if (chance == 0)
+                    TEST_ASSERT_FALSE(cell);
+                else if (chance == LifeRule::CERTAIN)
+                    TEST_ASSERT_TRUE(cell);
+                drawn[chance]++;
+                alive[chance] += cell ? 1 : 0;
+                reference.cells[x][y] = cell;
+            }
+        }
+        std::swap(current, next);
+    }
+
+    const uint16_t chances[] = {100, 250, 500};
+    for (uint16_t chance : chances)
+    {
+        TEST_ASSERT_GREATER_THAN(1000, drawn[chance]);
+        // 1000 * alive / drawn, within 3 percentage points
+        TEST_ASSERT_INT_WITHIN(30, chance, (int)(alive[chance] * 1000 / drawn[chance]));
+    }
+}
+
+// the same seed gives the same run
+static void test_same_seed_same_run()
+{
+    LifeRule rule(LIFE_RULE_HIGHLIFE);
+    rule.setSurvivalChance(0, 1, 50);
+    static ReferenceBoard reference;
+    LifeBoard a, b, next;
+    randomFill(reference, a, 5, 30);
+    b = a;
+    FastRandom rngA(77), rngB(77);
+    for (int generation = 0; generation < 200; generation++)
+    {
+        next.calcNextGeneration<DeadEdges>(a, rule, rngA);
+        a = next;
+        next.calcNextGeneration<DeadEdges>(b, rule, rngB);
+        b = next;
+    }
+    for (int x = 0; x < W; x++)
+    {
+        TEST_ASSERT_EQUAL_HEX32(a.getColumn(x), b.getColumn(x));
+    }
+}
+
+// a settled board only evaluates the tiles around what still changes
+static void test_settled_tiles_are_skipped()
+{
+    LifeRule rule(LIFE_RULE_CONWAY);
+    LifeBoard current, next;
+    FastRandom rng(1);
+    // a blinker in the middle of tile (3,1), everything else dead
+    current.setCell(28, 12, true);
+    current.setCell(28, 13, true);
+    current.setCell(28, 14, true);
+    for (int generation = 0; generation < 4; generation++)
+    {
+        next.calcNextGeneration<WrappedEdges>(current, rule, rng);
+        std::swap(current, next);
+    }
+    TEST_ASSERT_EQUAL_HEX32(LifeBoard::tileBit(3, 1), current.getChangedTiles());
+    TEST_ASSERT_EQUAL_INT(9, current.getEvaluatedTileCount());
+    TEST_ASSERT_TRUE(current.getCell(28, 13));
+}
+
+// per-cell reference and board generation times, for comparison. not checked
+static void test_benchmark()
+{
+    LifeRule rule(LIFE_RULE_CONWAY);
+    static ReferenceBoard reference;
+    LifeBoard current, next;
+    FastRandom rng(1);
+    const int generations = 2000;
+
+    // restarted every 100 generations so the board doesn't settle
+    auto start = std::chrono::steady_clock::now();
+    for (int generation = 0; generation < generations; generation++)
+    {
+        if (generation % 100 == 0)
+            randomFill(reference, current, generation, 40);
+        reference.step(rule, true);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int generation = 0; generation < generations; generation++)
+    {
+        if (generation % 100 == 0)
+            randomFill(reference, current, generation, 40);
+        next.calcNextGeneration<WrappedEdges>(current, rule, rng);
+        std::swap(current, next);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    char message[96];
+    snprintf(message, sizeof(message), "per cell %.1f us/generation, LifeBoard %.1f us/generation (fills included)",
+             std::chrono::duration<double, std::micro>(middle - start).count() / generations,
+             std::chrono::duration<double, std::micro>(end - middle).count() / generations);
+    TEST_MESSAGE(message);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_conway_matches_reference);
+    RUN_TEST(test_highlife_matches_reference);
+    RUN_TEST(test_day_and_night_matches_reference);
+    RUN_TEST(test_seeds_matches_reference);
+    RUN_TEST(test_generic_rule_matches_reference);
+    RUN_TEST(test_bands_in_any_order);
+    RUN_TEST(test_chances_follow_transition_table);
+    RUN_TEST(test_same_seed_same_run);
+    RUN_TEST(test_settled_tiles_are_skipped);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,143 @@
+#include <unity.h>
+#include "MemoryMonitor.h"
+
+// MemoryMonitor against heap figures set through the host heap_caps stand-in
+
+static const uint32_t INTERNAL_TOTAL = 320000;
+static const uint32_t PSRAM_TOTAL = 8 * 1024 * 1024;
+
+static void setHeap(uint32_t caps, size_t total, size_t free, size_t minimumFree, size_t largestBlock)
+{
+    HostHeap &heap = hostHeap(caps);
+    heap.total = total;
+    heap.free = free;
+    heap.minimumFree = minimumFree;
+    heap.largestBlock = largestBlock;
+}
+
+// take bytes from a heap (give them back if negative), as an allocation would
+static void allocate(uint32_t caps, long bytes)
+{
+    HostHeap &heap = hostHeap(caps);
+    heap.free -= bytes;
+    heap.minimumFree = std::min(heap.minimumFree, heap.free);
+    heap.largestBlock = std::min(heap.largestBlock, heap.free);
+}
+
+static void test_heap_stats()
+{
+    setHeap(MALLOC_CAP_INTERNAL, 1000, 1000, 800, 250);
+    setHeap(MALLOC_CAP_SPIRAM, 4000, 3000, 2000, 3000);
+    HeapStats stats;
+    MemoryMonitor::getHeapStats(MALLOC_CAP_INTERNAL, stats);
+    TEST_ASSERT_EQUAL_UINT32(1000, stats.total);
+    TEST_ASSERT_EQUAL_UINT32(1000, stats.free);
+    TEST_ASSERT_EQUAL_UINT32(800, stats.minimumFree);
+    TEST_ASSERT_EQUAL_UINT32(250, stats.largestBlock);
+    // three quarters of the free memory is outside the largest block
+    TEST_ASSERT_EQUAL_UINT8(75, stats.fragmentation);
+
+    // all free memory in one block
+    MemoryMonitor::getHeapStats(MALLOC_CAP_SPIRAM, stats);
+    TEST_ASSERT_EQUAL_UINT32(4000, stats.total);
+    TEST_ASSERT_EQUAL_UINT32(3000, stats.free);
+    TEST_ASSERT_EQUAL_UINT8(0, stats.fragmentation);
+
+    // the largest block's share is rounded down, so fragmentation rounds up
+    setHeap(MALLOC_CAP_INTERNAL, 1000, 300, 300, 299);
+    MemoryMonitor::getHeapStats(MALLOC_CAP_INTERNAL, stats);
+    TEST_ASSERT_EQUAL_UINT8(1, stats.fragmentation);
+
+    // nothing free, and no PSRAM at all
+    setHeap(MALLOC_CAP_INTERNAL, 1000, 0, 0, 0);
+    setHeap(MALLOC_CAP_SPIRAM, 0, 0, 0, 0);
+    MemoryMonitor::getHeapStats(MALLOC_CAP_INTERNAL, stats);
+    TEST_ASSERT_EQUAL_UINT8(0, stats.fragmentation);
+    MemoryMonitor::getHeapStats(MALLOC_CAP_SPIRAM, stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.total);
+    TEST_ASSERT_EQUAL_UINT8(0, stats.fragmentation);
+    MemoryMonitor::logSnapshot("No PSRAM");
+}
+
+// each checkpoint is charged with what each heap lost since the one before
+static void test_checkpoints()
+{
+    setHeap(MALLOC_CAP_INTERNAL, INTERNAL_TOTAL, 250000, 250000, 110000);
+    setHeap(MALLOC_CAP_SPIRAM, PSRAM_TOTAL, PSRAM_TOTAL - 2048, PSRAM_TOTAL - 2048, 4000000);
+    // used before begin() isn't charged to anything
+    allocate(MALLOC_CAP_INTERNAL, 777);
+    MemoryMonitor::begin();
+    TEST_ASSERT_EQUAL_INT(0, MemoryMonitor::getSubsystemCount());
+
+    allocate(MALLOC_CAP_INTERNAL, 12000);
+    MemoryMonitor::checkpoint("Panel");
+    allocate(MALLOC_CAP_INTERNAL, 96);
+    allocate(MALLOC_CAP_SPIRAM, 65536);
+    MemoryMonitor::checkpoint("Matrix");
+    MemoryMonitor::checkpoint("Nothing");
+    allocate(MALLOC_CAP_INTERNAL, -500);
+    allocate(MALLOC_CAP_SPIRAM, -65536);
+    MemoryMonitor::checkpoint("Freed");
+
+    const SubsystemMemory expected[] = {
+        {"Panel", 12000, 0},
+        {"Matrix", 96, 65536},
+        {"Nothing", 0, 0},
+        {"Freed", -500, -65536},
+    };
+    TEST_ASSERT_EQUAL_INT(4, MemoryMonitor::getSubsystemCount());
+    for (int i = 0; i < 4; i++)
+    {
+        const SubsystemMemory &memory = MemoryMonitor::getSubsystem(i);
+        TEST_ASSERT_EQUAL_STRING(expected[i].name, memory.name);
+        TEST_ASSERT_EQUAL_INT32(expected[i].internalBytes, memory.internalBytes);
+        TEST_ASSERT_EQUAL_INT32(expected[i].psramBytes, memory.psramBytes);
+    }
+
+    HeapStats stats;
+    MemoryMonitor::getHeapStats(MALLOC_CAP_INTERNAL, stats);
+    TEST_ASSERT_EQUAL_UINT32(250000 - 777 - 12096 + 500, stats.free);
+    TEST_ASSERT_EQUAL_UINT32(250000 - 777 - 12096, stats.minimumFree);
+    MemoryMonitor::logSnapshot("Checkpoints");
+
+    // begin() starts the list again from the heaps as they are
+    MemoryMonitor::begin();
+    TEST_ASSERT_EQUAL_INT(0, MemoryMonitor::getSubsystemCount());
+    allocate(MALLOC_CAP_SPIRAM, 10);
+    MemoryMonitor::checkpoint("Again");
+    TEST_ASSERT_EQUAL_INT32(0, MemoryMonitor::getSubsystem(0).internalBytes);
+    TEST_ASSERT_EQUAL_INT32(10, MemoryMonitor::getSubsystem(0).psramBytes);
+}
+
+// checkpoints past the limit are only logged, and begin() makes room again
+static void test_checkpoint_limit()
+{
+    setHeap(MALLOC_CAP_INTERNAL, INTERNAL_TOTAL, 250000, 250000, 110000);
+    setHeap(MALLOC_CAP_SPIRAM, 0, 0, 0, 0);
+    MemoryMonitor::begin();
+    for (int i = 0; i < MEMORY_MONITOR_MAX_SUBSYSTEMS + 4; i++)
+    {
+        allocate(MALLOC_CAP_INTERNAL, 100);
+        MemoryMonitor::checkpoint("Many");
+    }
+    TEST_ASSERT_EQUAL_INT(MEMORY_MONITOR_MAX_SUBSYSTEMS, MemoryMonitor::getSubsystemCount());
+    for (int i = 0; i < MEMORY_MONITOR_MAX_SUBSYSTEMS; i++)
+        TEST_ASSERT_EQUAL_INT32(100, MemoryMonitor::getSubsystem(i).internalBytes);
+
+    MemoryMonitor::begin();
+    allocate(MALLOC_CAP_INTERNAL, 1);
+    MemoryMonitor::checkpoint("After");
+    TEST_ASSERT_EQUAL_INT32(1, MemoryMonitor::getSubsystem(0).internalBytes);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_heap_stats);
+    RUN_TEST(test_checkpoints);
+    RUN_TEST(test_checkpoint_limit);
+    return UNITY_END();
+}
@@ -0,0 +1,175 @@
+#include <unity.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "TimeHistogram.h"
+#include "FastRandom.h"
+
+// each bucket runs from the top of the one before plus one to its own top
+static void test_buckets_are_contiguous()
+{
+    TEST_ASSERT_EQUAL_INT(0, TimeHistogram::bucketOf(0));
+    for (int i = 0; i < HISTOGRAM_BUCKETS - 1; i++)
+    {
+        uint32_t top = TimeHistogram::bucketTop(i);
+        TEST_ASSERT_EQUAL_INT(i, TimeHistogram::bucketOf(top));
+        TEST_ASSERT_EQUAL_INT(i + 1, TimeHistogram::bucketOf(top + 1));
+    }
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, TimeHistogram::bucketTop(HISTOGRAM_BUCKETS - 1));
+    TEST_ASSERT_EQUAL_INT(HISTOGRAM_BUCKETS - 1, TimeHistogram::bucketOf(UINT32_MAX));
+    TEST_ASSERT_EQUAL_INT(HISTOGRAM_BUCKETS - 1, TimeHistogram::bucketOf((uint32_t)1 << (HISTOGRAM_MAX_EXPONENT + 1)));
+}
+
+// exact below HISTOGRAM_LINEAR_BUCKETS µs, and a bucket's top within 25% of any time in it
+static void test_bucket_width()
+{
+    for (uint32_t micros = 0; micros < HISTOGRAM_LINEAR_BUCKETS; micros++)
+        TEST_ASSERT_EQUAL_UINT32(micros, TimeHistogram::bucketTop(TimeHistogram::bucketOf(micros)));
+
+    FastRandom rng(1);
+    for (int i = 0; i < 200000; i++)
+    {
+        // spread over every doubling up to the last bucket
+        uint32_t micros = HISTOGRAM_LINEAR_BUCKETS + (rng.next() >> (32 - 1 - rng.nextBelow(HISTOGRAM_MAX_EXPONENT)));
+        if (micros >= ((uint32_t)1 << (HISTOGRAM_MAX_EXPONENT + 1)))
+            continue;
+        uint32_t top = TimeHistogram::bucketTop(TimeHistogram::bucketOf(micros));
+        TEST_ASSERT_GREATER_OR_EQUAL(micros, top);
+        TEST_ASSERT_LESS_OR_EQUAL(micros + micros / 4, top);
+    }
+}
+
+static void test_empty()
+{
+    TimeHistogram histogram;
+    HistogramSnapshot s;
+    histogram.snapshot(s);
+    TEST_ASSERT_EQUAL_UINT32(0, s.count);
+    TEST_ASSERT_EQUAL_UINT32(0, s.min);
+    TEST_ASSERT_EQUAL_UINT32(0, s.max);
+    TEST_ASSERT_EQUAL_UINT32(0, s.p50);
+    TEST_ASSERT_EQUAL_UINT32(0, s.p99);
+
+    histogram.record(500);
+    histogram.clear();
+    histogram.snapshot(s);
+    TEST_ASSERT_EQUAL_UINT32(0, s.count);
+    TEST_ASSERT_EQUAL_UINT32(0, s.max);
+}
+
+// percentiles never go above the largest time
+static void test_percentiles_capped_at_max()
+{
+    TimeHistogram histogram;
+    HistogramSnapshot s;
+    histogram.record(1000);
+    histogram.snapshot(s);
+    TEST_ASSERT_EQUAL_UINT32(1, s.count);
+    TEST_ASSERT_EQUAL_UINT32(1000, s.min);
+    TEST_ASSERT_EQUAL_UINT32(1000, s.max);
+    TEST_ASSERT_EQUAL_UINT32(1000, s.p50);
+    TEST_ASSERT_EQUAL_UINT32(1000, s.p99);
+
+    // past the last doubling
+    histogram.record(3000000000u);
+    histogram.snapshot(s);
+    TEST_ASSERT_EQUAL_UINT32(3000000000u, s.max);
+    TEST_ASSERT_EQUAL_UINT32(3000000000u, s.p99);
+    TEST_ASSERT_EQUAL_UINT32(TimeHistogram::bucketTop(TimeHistogram::bucketOf(1000)), s.p50);
+}
+
+// each percentile is the top of the bucket holding the sample of that rank
+static void test_percentiles_match_sorted_samples()
+{
+    FastRandom rng(7);
+    const int sizes[] = {1, 2, 3, 10, 99, 100, 101, 1000, 54321};
+    for (int size : sizes)
+    {
+        TimeHistogram histogram;
+        std::vector<uint32_t> samples;
+        for (int i = 0; i < size; i++)
+        {
+            // mostly around a frame time, with a tail
+            uint32_t micros = 4000 + rng.nextBelow(2000);
+            if (rng.nextBelow(50) == 0)
+                micros = rng.nextBelow(100000);
+            samples.push_back(micros);
+            histogram.record(micros);
+        }
+        std::sort(samples.begin(), samples.end());
+        HistogramSnapshot s;
+        histogram.snapshot(s);
+        TEST_ASSERT_EQUAL_UINT32(size, s.count);
+        TEST_ASSERT_EQUAL_UINT32(samples.front(), s.min);
+        TEST_ASSERT_EQUAL_UINT32(samples.back(), s.max);
+
+        const uint32_t percents[] = {50, 95, 99};
+        const uint32_t values[] = {s.p50, s.p95, s.p99};
+        for (int p = 0; p < 3; p++)
+        {
+            uint32_t rank = (size * percents[p] + 99) / 100;
+            uint32_t exact = samples[rank - 1];
+            uint32_t expected = std::min(TimeHistogram::bucketTop(TimeHistogram::bucketOf(exact)), s.max);
+            TEST_ASSERT_EQUAL_UINT32(expected, values[p]);
+            TEST_ASSERT_GREATER_OR_EQUAL(exact, values[p]);
+            TEST_ASSERT_LESS_OR_EQUAL(exact + exact / 4, values[p]);
+        }
+    }
+}
+
+// one thread records while another takes snapshots: counts only grow, percentiles stay
+// in order and within the buckets recorded to, and the last snapshot is exact
+static void test_snapshot_while_recording()
+{
+    static TimeHistogram histogram;
+    const uint32_t samples = 2000000;
+    std::atomic<bool> done(false);
+    std::thread recorder([&]() {
+        FastRandom rng(3);
+        for (uint32_t i = 0; i < samples; i++)
+            histogram.record(100 + rng.nextBelow(100));
+        done.store(true);
+    });
+
+    const uint32_t lowest = TimeHistogram::bucketTop(TimeHistogram::bucketOf(100) - 1) + 1;
+    const uint32_t highest = TimeHistogram::bucketTop(TimeHistogram::bucketOf(199));
+    uint32_t lastCount = 0;
+    do
+    {
+        HistogramSnapshot s;
+        histogram.snapshot(s);
+        TEST_ASSERT_GREATER_OR_EQUAL(lastCount, s.count);
+        TEST_ASSERT_LESS_OR_EQUAL(samples, s.count);
+        lastCount = s.count;
+        TEST_ASSERT_LESS_OR_EQUAL(s.p95, s.p50);
+        TEST_ASSERT_LESS_OR_EQUAL(s.p99, s.p95);
+        // a sample half counted may not have set the maximum yet, capping them at 0
+        if (s.p50 != 0)
+        {
+            TEST_ASSERT_GREATER_OR_EQUAL(lowest, s.p50);
+            TEST_ASSERT_LESS_OR_EQUAL(highest, s.p99);
+        }
+    } while (!done.load());
+    recorder.join();
+
+    HistogramSnapshot s;
+    histogram.snapshot(s);
+    TEST_ASSERT_EQUAL_UINT32(samples, s.count);
+    TEST_ASSERT_EQUAL_UINT32(100, s.min);
+    TEST_ASSERT_EQUAL_UINT32(199, s.max);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_buckets_are_contiguous);
+    RUN_TEST(test_bucket_width);
+    RUN_TEST(test_empty);
+    RUN_TEST(test_percentiles_capped_at_max);
+    RUN_TEST(test_percentiles_match_sorted_samples);
+    RUN_TEST(test_snapshot_while_recording);
+    return UNITY_END();
+}